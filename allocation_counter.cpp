@@ -0,0 +1,62 @@
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace tbx_engine {
+
+namespace {
+thread_local std::uint64_t num_heap_allocations_on_this_thread = 0;
+std::atomic<std::uint64_t> total_num_heap_allocations{0};
+} // namespace
+
+std::uint64_t get_num_heap_allocations_on_this_thread() { return num_heap_allocations_on_this_thread; }
+
+std::uint64_t get_total_num_heap_allocations() { return total_num_heap_allocations.load(std::memory_order_relaxed); }
+
+#ifdef TBX_ENGINE_COUNT_ALLOCATIONS
+namespace {
+void *counted_malloc(std::size_t size) {
+    num_heap_allocations_on_this_thread++;
+    total_num_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    // NOTE: malloc(0) is allowed to return null but operator new must not
+    return std::malloc(size == 0 ? 1 : size);
+}
+} // namespace
+#endif
+
+} // namespace tbx_engine
+
+#ifdef TBX_ENGINE_COUNT_ALLOCATIONS
+
+// NOTE: only the non aligned forms are replaced, over aligned allocations still go to the default operator new and are
+// not counted
+
+void *operator new(std::size_t size) {
+    void *ptr = tbx_engine::counted_malloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return tbx_engine::counted_malloc(size); }
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return tbx_engine::counted_malloc(size); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <cstdint>
+
+namespace tbx_engine {
+
+/**
+ * @brief counts heap allocations made through operator new
+ *
+ * counting only happens when the engine is compiled with TBX_ENGINE_COUNT_ALLOCATIONS defined, because that replaces
+ * the global operator new and delete for the whole program, without it every count is zero and
+ * allocation_counting_enabled is false so callers can tell "no allocations" apart from "not counted"
+ *
+ */
+#ifdef TBX_ENGINE_COUNT_ALLOCATIONS
+constexpr bool allocation_counting_enabled = true;
+#else
+constexpr bool allocation_counting_enabled = false;
+#endif
+
+/// the number of allocations made by the calling thread since it started
+std::uint64_t get_num_heap_allocations_on_this_thread();
+
+/// the number of allocations made by every thread since the program started
+std::uint64_t get_total_num_heap_allocations();
+
+} // namespace tbx_engine
+
+#endif // ALLOCATION_COUNTER_HPP
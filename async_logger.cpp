@@ -0,0 +1,348 @@
+#include "async_logger.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+namespace tbx_engine {
+
+LogArgument::LogArgument(std::string_view text) : type(Type::text) {
+    if (text.size() <= max_text_length) {
+        text_length = static_cast<std::uint8_t>(text.size());
+        std::memcpy(text_value.data(), text.data(), text.size());
+    } else {
+        text_length = max_text_length;
+        std::memcpy(text_value.data(), text.data(), max_text_length - 3);
+        std::memcpy(text_value.data() + max_text_length - 3, "...", 3);
+    }
+}
+
+void LogArgument::append_to(std::string &out) const {
+    char buffer[32];
+    std::to_chars_result result{buffer, std::errc()};
+    switch (type) {
+    case Type::none:
+        return;
+    case Type::signed_integer:
+        result = std::to_chars(buffer, buffer + sizeof(buffer), signed_value);
+        break;
+    case Type::unsigned_integer:
+        result = std::to_chars(buffer, buffer + sizeof(buffer), unsigned_value);
+        break;
+    case Type::boolean:
+        out += unsigned_value != 0 ? "true" : "false";
+        return;
+    case Type::floating_point:
+        result = std::to_chars(buffer, buffer + sizeof(buffer), floating_point_value);
+        break;
+    case Type::text:
+        out.append(text_value.data(), text_length);
+        return;
+    }
+    out.append(buffer, result.ptr);
+}
+
+std::optional<LogLevel> parse_log_level(std::string_view name) {
+    for (std::size_t i = 0; i < log_level_names.size(); i++) {
+        if (name == log_level_names[i]) {
+            return static_cast<LogLevel>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+AsyncLogger::AsyncLogger(std::size_t queue_capacity)
+    : sections(std::make_unique<SectionState[]>(max_sections)),
+      slots(std::make_unique<Slot[]>(std::bit_ceil(std::max<std::size_t>(queue_capacity, 2)))),
+      capacity_mask(std::bit_ceil(std::max<std::size_t>(queue_capacity, 2)) - 1) {
+    for (std::size_t i = 0; i <= capacity_mask; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    // NOTE: section 0 always exists so that a default constructed LogSectionId logs somewhere sensible
+    register_section("general");
+}
+
+AsyncLogger::~AsyncLogger() {
+    {
+        std::lock_guard lock(writer_mutex);
+        stop_writing = true;
+    }
+    writer_wakeup.notify_all();
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+LogSectionId AsyncLogger::register_section(const std::string &name, const LogSectionSettings &settings) {
+    std::lock_guard lock(sections_mutex);
+    for (std::size_t i = 0; i < num_sections; i++) {
+        if (sections[i].name == name) {
+            return static_cast<LogSectionId>(i);
+        }
+    }
+    if (num_sections == max_sections) {
+        return static_cast<LogSectionId>(max_sections - 1);
+    }
+    auto section = static_cast<LogSectionId>(num_sections++);
+    sections[section].name = name;
+    set_section_settings(section, settings);
+    return section;
+}
+
+void AsyncLogger::set_section_settings(LogSectionId section, const LogSectionSettings &settings) {
+    SectionState &state = sections[section];
+    std::int64_t interval_ns = 0;
+    if (settings.max_records_per_second > 0) {
+        interval_ns = std::max<std::int64_t>(1, static_cast<std::int64_t>(1e9 / settings.max_records_per_second));
+    }
+    state.rate_interval_ns.store(interval_ns, std::memory_order_relaxed);
+    // NOTE: a burst of up to one second's worth is allowed, so a section logging once a frame at 10 records per second
+    // still gets 10 records out right after it starts instead of one
+    state.rate_burst_ns.store(std::max<std::int64_t>(0, 1'000'000'000 - interval_ns), std::memory_order_relaxed);
+    state.sample_one_in.store(std::max<std::uint32_t>(settings.sample_one_in, 1), std::memory_order_relaxed);
+    state.min_level.store(settings.min_level, std::memory_order_relaxed);
+}
+
+std::int64_t AsyncLogger::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::uint32_t AsyncLogger::get_thread_index() {
+    static std::atomic<std::uint32_t> next_thread_index{0};
+    thread_local std::uint32_t thread_index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+    return thread_index;
+}
+
+bool AsyncLogger::passes_rate_limit_and_sampling(LogSectionId section) {
+    SectionState &state = sections[section];
+
+    std::int64_t interval_ns = state.rate_interval_ns.load(std::memory_order_relaxed);
+    if (interval_ns > 0) {
+        std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now().time_since_epoch())
+                               .count();
+        std::int64_t burst_ns = state.rate_burst_ns.load(std::memory_order_relaxed);
+        std::int64_t arrival = state.theoretical_arrival_ns.load(std::memory_order_relaxed);
+        while (true) {
+            std::int64_t start = std::max(arrival, now);
+            if (start - now > burst_ns) {
+                num_records_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (state.theoretical_arrival_ns.compare_exchange_weak(arrival, start + interval_ns,
+                                                                   std::memory_order_relaxed)) {
+                break;
+            }
+        }
+    }
+
+    std::uint32_t sample_one_in = state.sample_one_in.load(std::memory_order_relaxed);
+    if (sample_one_in > 1 and state.num_sampled.fetch_add(1, std::memory_order_relaxed) % sample_one_in != 0) {
+        num_records_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool AsyncLogger::enqueue(const LogRecord &record) {
+    std::call_once(writer_started, [this]() { writer_thread = std::thread([this]() { writer_loop(); }); });
+    if (try_enqueue(record)) {
+        wake_writer_if_idle();
+        return true;
+    }
+    if (overflow_policy == LogOverflowPolicy::drop) {
+        num_records_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    wake_writer();
+    while (not try_enqueue(record)) {
+        std::this_thread::yield();
+    }
+    wake_writer_if_idle();
+    return true;
+}
+
+void AsyncLogger::wake_writer() {
+    {
+        std::lock_guard lock(writer_mutex);
+        writer_idle.store(false, std::memory_order_relaxed);
+    }
+    writer_wakeup.notify_one();
+}
+
+void AsyncLogger::wake_writer_if_idle() {
+    // NOTE: the slot was claimed with a seq_cst exchange on enqueue_position before this, and the writer sets
+    // writer_idle before it looks at enqueue_position, so either it sees our record or we see that it went idle
+    if (writer_idle.load(std::memory_order_seq_cst)) {
+        wake_writer();
+    }
+}
+
+bool AsyncLogger::is_queue_empty() const {
+    // NOTE: a slot that was claimed but not filled in yet counts, the writer then keeps looking until it is
+    return enqueue_position.load(std::memory_order_seq_cst) == dequeue_position;
+}
+
+// NOTE: this is the bounded queue by dmitry vyukov, each slot's sequence says whose turn it is, producers claim a slot
+// by bumping enqueue_position and publish it by bumping its sequence, so they never wait on each other or the writer
+bool AsyncLogger::try_enqueue(const LogRecord &record) {
+    std::size_t position = enqueue_position.load(std::memory_order_relaxed);
+    while (true) {
+        Slot &slot = slots[position & capacity_mask];
+        std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if (difference == 0) {
+            // NOTE: seq_cst costs nothing extra on x86 and lets wake_writer_if_idle get away without a fence
+            if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_seq_cst,
+                                                       std::memory_order_relaxed)) {
+                slot.record = record;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool AsyncLogger::try_dequeue(LogRecord &record) {
+    Slot &slot = slots[dequeue_position & capacity_mask];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_position + 1) {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(dequeue_position + capacity_mask + 1, std::memory_order_release);
+    dequeue_position++;
+    return true;
+}
+
+void AsyncLogger::format_record(const LogRecord &record, std::string &out) const {
+    std::int64_t ms_of_day = record.time_ns / 1'000'000 % (24 * 60 * 60 * 1000);
+    // NOTE: the system clock counts from the unix epoch so this is the time of day in utc, not local time
+    char time[32];
+    std::snprintf(time, sizeof(time), "%02d:%02d:%02d.%03d", static_cast<int>(ms_of_day / 3'600'000),
+                  static_cast<int>(ms_of_day / 60'000 % 60), static_cast<int>(ms_of_day / 1000 % 60),
+                  static_cast<int>(ms_of_day % 1000));
+
+    out += '[';
+    out += time;
+    out += "] [";
+    out += log_level_names[static_cast<std::size_t>(record.level)];
+    out += "] [";
+    out += sections[record.section].name;
+    out += "] [t";
+    char thread_index[12];
+    out.append(thread_index, std::to_chars(thread_index, thread_index + sizeof(thread_index), record.thread_index).ptr);
+    out += "] ";
+
+    std::size_t next_argument = 0;
+    for (const char *c = record.format; *c != '\0'; c++) {
+        if (c[0] == '{' and c[1] == '}' and next_argument < record.num_arguments) {
+            record.arguments[next_argument++].append_to(out);
+            c++;
+        } else {
+            out += *c;
+        }
+    }
+    out += '\n';
+}
+
+void AsyncLogger::writer_loop() {
+    std::string batch;
+    LogRecord record;
+    std::uint64_t num_drops_reported = 0;
+
+    std::unique_lock lock(writer_mutex);
+    while (true) {
+        // NOTE: while records keep coming the writer looks every few ms, that way producers never have to wake it up
+        // which would cost them a syscall each, only once the queue is empty it sleeps until the next record
+        if (is_queue_empty()) {
+            writer_idle.store(true, std::memory_order_seq_cst);
+            if (not is_queue_empty()) {
+                writer_idle.store(false, std::memory_order_relaxed);
+            }
+            writer_wakeup.wait(lock, [&]() { return not writer_idle.load(std::memory_order_relaxed) or stop_writing; });
+        } else {
+            writer_wakeup.wait_for(lock, std::chrono::milliseconds(5));
+        }
+        bool stopping = stop_writing;
+        lock.unlock();
+
+        std::uint64_t num_formatted = 0;
+        while (try_dequeue(record)) {
+            format_record(record, batch);
+            num_formatted++;
+        }
+        std::uint64_t num_dropped = num_records_dropped.load(std::memory_order_relaxed);
+        if (num_dropped != num_drops_reported) {
+            batch += "[async logger] the queue was full, dropped " + std::to_string(num_dropped - num_drops_reported) +
+                     " records\n";
+            num_drops_reported = num_dropped;
+        }
+
+        lock.lock();
+        if (not batch.empty()) {
+            if (sink) {
+                sink(batch);
+            } else {
+                std::fwrite(batch.data(), 1, batch.size(), file != nullptr ? file : stderr);
+                std::fflush(file != nullptr ? file : stderr);
+            }
+            batch.clear();
+        }
+        num_records_written.fetch_add(num_formatted, std::memory_order_release);
+        records_written.notify_all();
+
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+void AsyncLogger::flush() {
+    // NOTE: a slot claimed by now but not yet filled in still counts, the writer picks it up once its producer is done
+    std::size_t num_claimed = enqueue_position.load(std::memory_order_acquire);
+    std::unique_lock lock(writer_mutex);
+    writer_idle.store(false, std::memory_order_relaxed);
+    writer_wakeup.notify_one();
+    records_written.wait(lock, [&]() {
+        // NOTE: dropped records never reach the queue, so they are neither claimed nor written
+        return num_records_written.load(std::memory_order_acquire) >= num_claimed or stop_writing;
+    });
+}
+
+void AsyncLogger::set_sink(std::function<void(std::string_view)> sink) {
+    std::lock_guard lock(writer_mutex);
+    this->sink = std::move(sink);
+}
+
+bool AsyncLogger::open_file(const std::string &path) {
+    std::FILE *new_file = std::fopen(path.c_str(), "a");
+    if (new_file == nullptr) {
+        return false;
+    }
+    std::lock_guard lock(writer_mutex);
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+    file = new_file;
+    sink = nullptr;
+    return true;
+}
+
+AsyncLoggerStats AsyncLogger::get_stats() const {
+    return {num_records_written.load(std::memory_order_relaxed), num_records_dropped.load(std::memory_order_relaxed),
+            num_records_suppressed.load(std::memory_order_relaxed)};
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,253 @@
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace tbx_engine {
+
+enum class LogLevel : std::uint8_t { trace, debug, info, warn, error, off };
+
+const std::array<const char *, 6> log_level_names = {"trace", "debug", "info", "warn", "error", "off"};
+
+/// the inverse of log_level_names
+std::optional<LogLevel> parse_log_level(std::string_view name);
+
+/// what happens when a record is logged while the queue is full
+enum class LogOverflowPolicy : std::uint8_t {
+    /// the record is thrown away and counted, the writer then logs how many were dropped, logging never waits
+    drop,
+    /// the logging thread yields until the writer has made room, nothing is lost but a stalled disk stalls the caller
+    block
+};
+
+struct LogSectionSettings {
+    /// records below this level are discarded before they are queued, which costs one atomic load
+    LogLevel min_level = LogLevel::info;
+    /// 0 means unlimited, otherwise at most this many records per second are kept, with bursts of up to a second's
+    /// worth
+    double max_records_per_second = 0;
+    /// of the records that pass the level and the rate limit only every nth is kept, 1 keeps them all
+    std::uint32_t sample_one_in = 1;
+};
+
+using LogSectionId = std::uint16_t;
+
+/// one argument of a log record, held by value so nothing it refers to has to outlive the call
+class LogArgument {
+  public:
+    static constexpr std::size_t max_text_length = 31;
+
+    LogArgument() = default;
+
+    template <typename T>
+        requires std::is_integral_v<T>
+    LogArgument(T value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            type = Type::boolean;
+            unsigned_value = value;
+        } else if constexpr (std::is_signed_v<T>) {
+            type = Type::signed_integer;
+            signed_value = value;
+        } else {
+            type = Type::unsigned_integer;
+            unsigned_value = value;
+        }
+    }
+    LogArgument(double value) : type(Type::floating_point), floating_point_value(value) {}
+    /// text longer than max_text_length is cut off and ends in ...
+    LogArgument(std::string_view text);
+    LogArgument(const char *text) : LogArgument(std::string_view(text)) {}
+    LogArgument(const std::string &text) : LogArgument(std::string_view(text)) {}
+
+    void append_to(std::string &out) const;
+
+  private:
+    enum class Type : std::uint8_t { none, signed_integer, unsigned_integer, boolean, floating_point, text };
+
+    Type type = Type::none;
+    std::uint8_t text_length = 0;
+    std::array<char, max_text_length> text_value;
+    union {
+        std::int64_t signed_value;
+        std::uint64_t unsigned_value;
+        double floating_point_value;
+    };
+};
+
+/// what goes through the queue, the message is only put together on the writer thread
+struct LogRecord {
+    static constexpr std::size_t max_arguments = 6;
+
+    std::int64_t time_ns;
+    /// must be a string literal or otherwise live as long as the logger, each {} in it is replaced by an argument
+    const char *format;
+    std::uint32_t thread_index;
+    LogSectionId section;
+    LogLevel level;
+    std::uint8_t num_arguments;
+    std::array<LogArgument, max_arguments> arguments;
+};
+
+struct AsyncLoggerStats {
+    std::uint64_t num_records_written = 0;
+    /// lost because the queue was full under LogOverflowPolicy::drop
+    std::uint64_t num_records_dropped = 0;
+    /// discarded by a section's rate limit or sampling
+    std::uint64_t num_records_suppressed = 0;
+};
+
+/**
+ * @brief a logger whose callers only copy a small binary record into a lock free queue, a writer thread formats the
+ * records and writes them out in batches, so a slow disk or terminal never shows up in the frame time
+ *
+ * records belong to sections, each with its own level, rate limit and sampling which are all applied before anything is
+ * queued, so a verbose section that is throttled costs next to nothing, see LogOverflowPolicy for what happens when
+ * the writer falls behind
+ *
+ * each line starts with the time of day the record was logged at in utc, then its level, section and thread
+ *
+ * the writer thread is only started by the first record and sleeps while the queue is empty, so a logger nobody logs to
+ * costs nothing
+ *
+ * @note every function can be called from any thread, except that sections should be registered before other threads
+ * log to them
+ */
+class AsyncLogger {
+  public:
+    static constexpr std::size_t max_sections = 256;
+
+    /// @param queue_capacity rounded up to a power of two
+    explicit AsyncLogger(std::size_t queue_capacity = 1 << 13);
+    /// writes everything still queued
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger &) = delete;
+    AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+    /// registering a name twice returns the same section, when all sections are taken the last one is shared
+    LogSectionId register_section(const std::string &name, const LogSectionSettings &settings = {});
+    void set_section_settings(LogSectionId section, const LogSectionSettings &settings);
+    const std::string &get_section_name(LogSectionId section) const { return sections[section].name; }
+
+    /// cheap enough to guard building expensive arguments
+    bool is_enabled(LogSectionId section, LogLevel level) const {
+        return level >= sections[section].min_level.load(std::memory_order_relaxed) and level != LogLevel::off;
+    }
+
+    /// @param format must be a string literal, {} is replaced by the next argument
+    /// @return false if the record was filtered, suppressed or dropped
+    template <typename... Args> bool log(LogSectionId section, LogLevel level, const char *format, Args &&...args) {
+        static_assert(sizeof...(Args) <= LogRecord::max_arguments, "too many log arguments");
+        if (not is_enabled(section, level) or not passes_rate_limit_and_sampling(section)) {
+            return false;
+        }
+        LogRecord record{now_ns(), format, get_thread_index(), section, level, sizeof...(Args), {}};
+        std::size_t i = 0;
+        ((record.arguments[i++] = LogArgument(std::forward<Args>(args))), ...);
+        return enqueue(record);
+    }
+
+    /// blocks until every record logged before the call has been handed to the sink
+    void flush();
+
+    /// replaces where formatted lines go, the default is stderr, a batch of lines is passed at once
+    /// @note called on the writer thread
+    void set_sink(std::function<void(std::string_view)> sink);
+    /// appends to a file instead of writing to stderr
+    bool open_file(const std::string &path);
+
+    LogOverflowPolicy overflow_policy = LogOverflowPolicy::drop;
+
+    AsyncLoggerStats get_stats() const;
+
+  private:
+    struct SectionState {
+        std::string name;
+        std::atomic<LogLevel> min_level{LogLevel::info};
+        std::atomic<std::int64_t> rate_interval_ns{0};
+        std::atomic<std::int64_t> rate_burst_ns{0};
+        /// the rate limit is a generic cell rate algorithm, this is when the bucket would next be empty
+        std::atomic<std::int64_t> theoretical_arrival_ns{0};
+        std::atomic<std::uint32_t> sample_one_in{1};
+        std::atomic<std::uint64_t> num_sampled{0};
+    };
+
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        LogRecord record;
+    };
+
+    static std::int64_t now_ns();
+    static std::uint32_t get_thread_index();
+
+    bool passes_rate_limit_and_sampling(LogSectionId section);
+    bool enqueue(const LogRecord &record);
+    bool try_enqueue(const LogRecord &record);
+    bool try_dequeue(LogRecord &record);
+    /// only called by the writer
+    bool is_queue_empty() const;
+    void wake_writer();
+    void wake_writer_if_idle();
+
+    void writer_loop();
+    void format_record(const LogRecord &record, std::string &out) const;
+
+    std::unique_ptr<SectionState[]> sections;
+    std::size_t num_sections = 0;
+    std::mutex sections_mutex;
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t capacity_mask;
+    alignas(64) std::atomic<std::size_t> enqueue_position{0};
+    alignas(64) std::size_t dequeue_position = 0;
+
+    std::atomic<std::uint64_t> num_records_written{0};
+    std::atomic<std::uint64_t> num_records_dropped{0};
+    std::atomic<std::uint64_t> num_records_suppressed{0};
+
+    std::mutex writer_mutex;
+    std::condition_variable writer_wakeup;
+    std::condition_variable records_written;
+    std::function<void(std::string_view)> sink;
+    std::FILE *file = nullptr;
+    bool stop_writing = false;
+    /// set by the writer before it sleeps until it's woken up instead of looking again in a few ms
+    std::atomic<bool> writer_idle{false};
+    std::once_flag writer_started;
+    std::thread writer_thread;
+};
+
+/// logs the start and end of a scope to a section at trace level, a drop in replacement for GlobalLogSection in code
+/// that runs every frame
+class AsyncLogScope {
+  public:
+    AsyncLogScope(AsyncLogger &logger, LogSectionId section, const char *scope_name)
+        : logger(logger), section(section), scope_name(scope_name) {
+        logger.log(section, LogLevel::trace, "start {}", scope_name);
+    }
+    ~AsyncLogScope() { logger.log(section, LogLevel::trace, "end {}", scope_name); }
+
+    AsyncLogScope(const AsyncLogScope &) = delete;
+    AsyncLogScope &operator=(const AsyncLogScope &) = delete;
+
+  private:
+    AsyncLogger &logger;
+    LogSectionId section;
+    const char *scope_name;
+};
+
+} // namespace tbx_engine
+
+#endif // ASYNC_LOGGER_HPP
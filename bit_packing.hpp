@@ -0,0 +1,83 @@
+#ifndef BIT_PACKING_HPP
+#define BIT_PACKING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace tbx_engine {
+
+/// appends values of any width up to 32 bits to a byte buffer with no padding between them, least significant bit first
+class BitWriter {
+  public:
+    explicit BitWriter(std::vector<std::uint8_t> &buffer) : buffer(buffer) {}
+
+    void write_bits(std::uint32_t value, int num_bits) {
+        for (int i = 0; i < num_bits; i++) {
+            if (num_bits_written % 8 == 0) {
+                buffer.push_back(0);
+            }
+            if ((value >> i) & 1) {
+                buffer.back() |= std::uint8_t(1 << (num_bits_written % 8));
+            }
+            num_bits_written++;
+        }
+    }
+
+    void write_bool(bool value) { write_bits(value ? 1 : 0, 1); }
+
+    std::size_t get_num_bits_written() const { return num_bits_written; }
+
+  private:
+    std::vector<std::uint8_t> &buffer;
+    std::size_t num_bits_written = 0;
+};
+
+/// reads what a BitWriter wrote, reading past the end yields zeros and sets the overflow flag instead of failing
+class BitReader {
+  public:
+    BitReader(const std::uint8_t *data, std::size_t size_bytes) : data(data), size_bits(size_bytes * 8) {}
+
+    std::uint32_t read_bits(int num_bits) {
+        std::uint32_t value = 0;
+        for (int i = 0; i < num_bits; i++) {
+            if (num_bits_read >= size_bits) {
+                overflowed = true;
+                return 0;
+            }
+            if ((data[num_bits_read / 8] >> (num_bits_read % 8)) & 1) {
+                value |= std::uint32_t(1) << i;
+            }
+            num_bits_read++;
+        }
+        return value;
+    }
+
+    bool read_bool() { return read_bits(1) != 0; }
+
+    /// true once a read went past the end, every value read after that point is garbage
+    bool has_overflowed() const { return overflowed; }
+
+  private:
+    const std::uint8_t *data;
+    std::size_t size_bits;
+    std::size_t num_bits_read = 0;
+    bool overflowed = false;
+};
+
+/// maps value in [min_value, max_value] onto an integer with num_bits bits, values outside the range are clamped
+inline std::uint32_t quantize_float(float value, float min_value, float max_value, int num_bits) {
+    std::uint32_t max_quantized = (std::uint64_t(1) << num_bits) - 1;
+    float normalized = std::clamp((value - min_value) / (max_value - min_value), 0.0f, 1.0f);
+    return static_cast<std::uint32_t>(std::lround(normalized * max_quantized));
+}
+
+inline float dequantize_float(std::uint32_t quantized, float min_value, float max_value, int num_bits) {
+    std::uint32_t max_quantized = (std::uint64_t(1) << num_bits) - 1;
+    return min_value + (max_value - min_value) * (static_cast<float>(quantized) / max_quantized);
+}
+
+} // namespace tbx_engine
+
+#endif // BIT_PACKING_HPP
@@ -0,0 +1,669 @@
+#ifndef COMPOSED_TOOLBOX_ENGINE_HPP
+#define COMPOSED_TOOLBOX_ENGINE_HPP
+
+#include "toolbox_engine.hpp"
+#include "sound_streaming.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace tbx_engine {
+
+/// the optional top level systems of a ComposedToolboxEngine, pass the ones you want as its template arguments
+struct WithBatcher {};
+/// requires WithBatcher
+struct WithUIRendering {};
+struct WithSound {};
+/// requires WithBatcher, WithUIRendering and WithSound
+struct WithMenu {};
+
+template <typename System, typename... Systems>
+constexpr bool contains_system = (std::is_same_v<System, Systems> or ...);
+
+/// packs the constructor arguments of a system for OptionalSystem, lvalues are kept as references
+template <typename... Args> std::tuple<Args...> system_args(Args &&...args) {
+    return std::tuple<Args...>(std::forward<Args>(args)...);
+}
+
+/**
+ * @brief is a T when enabled and nothing otherwise, declared [[no_unique_address]] a disabled system takes up no
+ * space and its constructor is never run
+ *
+ * make(engine) returns the system's constructor arguments from system_args, make should be a generic lambda, that way
+ * its body is only compiled when the system is enabled, so it can refer to other systems which might not exist
+ */
+template <typename T, bool enabled> class OptionalSystem : public T {
+  public:
+    static constexpr bool is_enabled = true;
+
+    template <typename Engine, typename MakeFunc>
+    OptionalSystem(Engine &engine, MakeFunc &&make)
+        : OptionalSystem(make(engine), std::make_index_sequence<std::tuple_size_v<decltype(make(engine))>>()) {}
+
+  private:
+    // NOTE: T is constructed in place from the arguments so it doesn't have to be movable, initializing a base from a
+    // prvalue T would need a move
+    template <typename ArgsTuple, std::size_t... I>
+    OptionalSystem(ArgsTuple &&args, std::index_sequence<I...>) : T(std::get<I>(std::move(args))...) {}
+};
+
+template <typename T> class OptionalSystem<T, false> {
+  public:
+    static constexpr bool is_enabled = false;
+
+    template <typename Engine, typename MakeFunc> OptionalSystem(Engine &, MakeFunc &&) {}
+};
+
+/**
+ * @brief a windowed engine where each top level system beyond the window and camera is chosen at compile time
+ *
+ * eg ComposedToolboxEngine<WithBatcher> is a tool build with a window, camera and batcher but no audio device, menu
+ * or ui renderer, systems that aren't selected take no space, are never constructed and nothing in the tick checks for
+ * them at runtime, functions which need a missing system don't compile
+ *
+ * ToolboxEngine is this with every system and stays the default
+ *
+ * @pre with WithBatcher you have to have generated the batcher for the absolute_position_with_colored_vertex shader,
+ * this is probably the simplest shader that allows you to express objects with color so I don't find this to be a huge
+ * dependency
+ *
+ * @note this only decides what is constructed, the subproject still depends on everything in sbpt.ini so a missing
+ * system's code is still compiled and linked, sbpt has one dependency list per subproject so it can't be trimmed per
+ * variant
+ */
+template <typename... Systems> class ComposedToolboxEngine : public ToolboxEngineCore {
+  public:
+    static constexpr bool has_batcher = contains_system<WithBatcher, Systems...>;
+    static constexpr bool has_ui_rendering = contains_system<WithUIRendering, Systems...>;
+    static constexpr bool has_sound = contains_system<WithSound, Systems...>;
+    static constexpr bool has_menu = contains_system<WithMenu, Systems...>;
+
+    static_assert(not has_ui_rendering or has_batcher, "WithUIRendering requires WithBatcher");
+    static_assert(not has_menu or (has_batcher and has_ui_rendering and has_sound),
+                  "WithMenu requires WithBatcher, WithUIRendering and WithSound");
+
+  private:
+    const std::pair<int, int> default_resolution = {1280, 720};
+
+  public:
+    bool window_should_close() { return glfwWindowShouldClose(window.glfw_window); }
+
+    /// a wrapper around the main loop start function so we can inject engine specfic logic around what the user wants
+    /// to do.
+    void start(const std::function<void(double)> &rate_limited_func,
+               const std::optional<std::function<bool()>> &termination_condition_func = std::nullopt,
+               std::optional<std::function<void(IterationStats)>> loop_stats_function = std::nullopt) {
+        std::function<bool()> term =
+            termination_condition_func.value_or([&]() { return stop_requested or window_should_close(); });
+
+        run_main_loop(
+            [&](double dt) {
+                {
+                    TBX_PROFILE_SCOPE("start_of_tick_glfw_logic");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::window);
+                    window.start_of_tick_glfw_logic();
+                }
+                drain_input_events();
+                {
+                    TBX_PROFILE_SCOPE("rate_limited_func");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::update);
+                    rate_limited_func(dt);
+                }
+                {
+                    // NOTE: jobs might still be writing to what was just queued for drawing, so they must finish
+                    // before the buffers are swapped
+                    TBX_PROFILE_SCOPE("job_system.wait_for_all");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::jobs);
+                    job_system.wait_for_all();
+                }
+                {
+                    TBX_PROFILE_SCOPE("end_of_tick_glfw_logic");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::present);
+                    window.end_of_tick_glfw_logic();
+                }
+            },
+            // NOTE: the jobs were already waited on before the swap, so run_main_loop doesn't wait a second time
+            term, loop_stats_function, false);
+    };
+
+    /**
+     * @brief runs the simulation on a worker thread and rendering on this thread, the two only share data through
+     * lock free triple buffers
+     *
+     * the main thread keeps running the main loop, so glfw events, input processing, replays and frame pacing work as
+     * they do in start, each of its ticks publishes an InputSnapshot and calls render with the newest simulation state,
+     * the worker thread runs simulate at simulation_rate_hz (max_fps by default) on its own copy of the state and
+     * publishes a copy after every tick, so a slow simulation tick never delays a frame
+     *
+     * @param simulate called as simulate(dt, const SimulationInput &, SimulationState &) on the worker thread, it must
+     * not touch the window, the input state, the camera or the batcher, those belong to the main thread
+     * @param render called as render(const SimulationState &) on the main thread
+     *
+     * @note the state is copied once per simulation tick so it should be cheap to copy, if the simulation throws the
+     * exception is rethrown here after both loops have stopped
+     */
+    template <typename SimulationState, typename SimulateFunc, typename RenderFunc>
+    void start_threaded(const SimulationState &initial_state, SimulateFunc &&simulate, RenderFunc &&render,
+                        const std::optional<std::function<bool()>> &termination_condition_func = std::nullopt,
+                        std::optional<double> simulation_rate_hz = std::nullopt) {
+        TripleBuffer<SimulationState> simulation_states(initial_state);
+        TripleBuffer<InputSnapshot> input_snapshots;
+        std::atomic<bool> simulation_should_stop{false};
+        std::exception_ptr simulation_exception;
+
+        FramePacer simulation_pacer;
+        simulation_pacer.strategy = frame_pacer.strategy;
+        simulation_pacer.set_target_rate_hz(simulation_rate_hz.has_value() ? simulation_rate_hz
+                                                                            : frame_pacer.get_target_rate_hz());
+
+        std::thread simulation_thread([&]() {
+            try {
+                SimulationState state = initial_state;
+                SimulationInput simulation_input;
+                auto last_tick_time = std::chrono::steady_clock::now();
+                while (not simulation_should_stop.load(std::memory_order_acquire)) {
+                    TBX_PROFILE_SCOPE("simulation_tick");
+                    auto now = std::chrono::steady_clock::now();
+                    double dt = std::chrono::duration<double>(now - last_tick_time).count();
+                    last_tick_time = now;
+
+                    input_snapshots.update_read_buffer();
+                    simulation_input.update(input_snapshots.get_read_buffer());
+                    simulate(dt, simulation_input, state);
+
+                    simulation_states.get_write_buffer() = state;
+                    simulation_states.publish();
+                    simulation_pacer.wait_for_next_frame();
+                }
+            } catch (...) {
+                simulation_exception = std::current_exception();
+                simulation_should_stop.store(true, std::memory_order_release);
+            }
+        });
+
+        InputSnapshot input_snapshot;
+        std::function<bool()> term = termination_condition_func.value_or(
+            [&]() { return stop_requested or window_should_close(); });
+
+        run_main_loop(
+            [&](double dt) {
+                {
+                    TBX_PROFILE_SCOPE("start_of_tick_glfw_logic");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::window);
+                    window.start_of_tick_glfw_logic();
+                }
+                drain_input_events();
+
+                update_input_snapshot(input_snapshot);
+                input_snapshots.get_write_buffer() = input_snapshot;
+                input_snapshots.publish();
+
+                simulation_states.update_read_buffer();
+                {
+                    TBX_PROFILE_SCOPE("render");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::update);
+                    render(simulation_states.get_read_buffer());
+                }
+                {
+                    TBX_PROFILE_SCOPE("end_of_tick_glfw_logic");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::present);
+                    window.end_of_tick_glfw_logic();
+                }
+            },
+            [&]() { return simulation_should_stop.load(std::memory_order_acquire) or term(); }, std::nullopt,
+            false);
+
+        simulation_should_stop.store(true, std::memory_order_release);
+        simulation_thread.join();
+        if (simulation_exception) {
+            std::rethrow_exception(simulation_exception);
+        }
+    }
+
+    /// decides how many simulation steps each frame of start_fixed_timestep runs and how far between two steps it is
+    FixedTimestep fixed_timestep;
+    /// where fps_camera was at the end of the last two simulation steps, see start_fixed_timestep
+    InterpolatedPosition interpolated_camera_position;
+
+    /**
+     * @brief simulates in steps of a fixed size and renders every frame in between, so eg the simulation can run at 60
+     * hz while frames are rendered at 240, or as fast as possible when max_fps is inf, without the simulation changing
+     *
+     * each frame runs as many steps as fixed_timestep says are due, none when frames are faster than the steps, then
+     * renders with the alpha of how far the frame is between the last step and the next, state that the simulation
+     * moves should be drawn blended by alpha between its last two steps, fps_camera's position is done here, it is
+     * moved to the blend of where the last two steps left it for rendering and put back before the next step
+     *
+     * @param simulate called as simulate(step_dt, const SimulationInput &) on this thread, actions pressed on frames
+     * without a step show up as just pressed in the next step, move the camera here and not in render, eg with
+     * update_camera_position_with_default_movement
+     * @param render called as render(alpha) once per frame
+     * @param simulation_rate_hz the rate of the steps, the frame rate is still max_fps
+     *
+     * @note the camera's rotation isn't blended, it follows the mouse every frame so looking around stays responsive
+     */
+    template <typename SimulateFunc, typename RenderFunc>
+    void start_fixed_timestep(SimulateFunc &&simulate, RenderFunc &&render, double simulation_rate_hz = 60,
+                              const std::optional<std::function<bool()>> &termination_condition_func = std::nullopt,
+                              std::optional<std::function<void(IterationStats)>> loop_stats_function = std::nullopt) {
+        fixed_timestep.set_step_rate_hz(simulation_rate_hz);
+        fixed_timestep.reset();
+        interpolated_camera_position.reset(fps_camera.transform.get_translation());
+
+        InputSnapshot input_snapshot;
+        SimulationInput simulation_input;
+        std::function<bool()> term =
+            termination_condition_func.value_or([&]() { return stop_requested or window_should_close(); });
+
+        run_main_loop(
+            [&](double dt) {
+                {
+                    TBX_PROFILE_SCOPE("start_of_tick_glfw_logic");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::window);
+                    window.start_of_tick_glfw_logic();
+                }
+                drain_input_events();
+                update_input_snapshot(input_snapshot);
+
+                int num_steps = fixed_timestep.advance(dt);
+                if (num_steps > 0) {
+                    TBX_PROFILE_SCOPE("simulate");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::update);
+                    fps_camera.transform.set_translation(interpolated_camera_position.get_current());
+                    for (int i = 0; i < num_steps; i++) {
+                        // NOTE: only the first step of a frame sees the presses since the last step
+                        simulation_input.update(input_snapshot);
+                        simulate(fixed_timestep.get_step_s(), std::as_const(simulation_input));
+                        interpolated_camera_position.push(fps_camera.transform.get_translation());
+                    }
+                }
+                fps_camera.transform.set_translation(interpolated_camera_position.get(fixed_timestep.get_alpha()));
+
+                {
+                    TBX_PROFILE_SCOPE("render");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::update);
+                    render(fixed_timestep.get_alpha());
+                }
+                {
+                    TBX_PROFILE_SCOPE("job_system.wait_for_all");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::jobs);
+                    job_system.wait_for_all();
+                }
+                {
+                    TBX_PROFILE_SCOPE("end_of_tick_glfw_logic");
+                    FramePhaseTimer phase_timer(frame_telemetry, FramePhase::present);
+                    window.end_of_tick_glfw_logic();
+                }
+            },
+            // NOTE: the jobs were already waited on before the swap, so run_main_loop doesn't wait a second time
+            term, loop_stats_function, false);
+    }
+
+  private:
+    /// the input as of this tick for a simulation that doesn't run once per tick, presses are counted so none are
+    /// missed by a simulation that skips ticks
+    void update_input_snapshot(InputSnapshot &input_snapshot) {
+        input_snapshot.pressed_actions = action_bindings.get_pressed_actions(input_state);
+        for (std::size_t i = 0; i < num_movement_actions; i++) {
+            auto action = static_cast<MovementAction>(i);
+            if (input_state.is_just_pressed(action_bindings.get_key(action))) {
+                input_snapshot.action_press_counts[i]++;
+            }
+        }
+        input_snapshot.mouse_position_x = input_state.mouse_position_x;
+        input_snapshot.mouse_position_y = input_state.mouse_position_y;
+        input_snapshot.camera_transform = fps_camera.transform;
+        input_snapshot.frame_index = tick_index;
+    }
+
+    // NOTE: loading the sounds doesn't need the gl context, so it happens on the job system while the window is opened
+    // and the shaders are built, the members below are in the order of the startup stages, each marker starts a stage
+    [[no_unique_address]] OptionalSystem<BackgroundStartupStage<SoundSystem>, has_sound> sound_system_stage;
+    StartupStageMarker window_stage{startup_report, "window"};
+
+  public:
+    std::pair<int, int> requested_resolution;
+
+    Window window;
+
+    GLFWLambdaCallbackManager glfw_lambda_callback_manager;
+
+    std::vector<ShaderType> requested_shaders;
+
+  private:
+    StartupStageMarker shader_cache_stage{startup_report, "shader_cache and batcher"};
+
+  public:
+    ShaderCache shader_cache;
+    [[no_unique_address]] OptionalSystem<Batcher, has_batcher> batcher;
+
+  private:
+    [[no_unique_address]] OptionalSystem<BackgroundStartupStageWait<SoundSystem>, has_sound> sound_system_wait_stage;
+
+  public:
+    /// only used when the engine has WithSound
+    std::unordered_map<SoundType, std::string> sound_type_to_file;
+
+    // NOTE: there's no SoundCache here on purpose, SoundSystem can only play what it loaded itself, so a cache of the
+    // same files would keep every sound resident twice, it's for programs that play through their own output device
+    /// streams long sounds like music from disk on a background thread instead of decoding them up front
+    [[no_unique_address]] OptionalSystem<SoundStreamer, has_sound> sound_streamer;
+
+  private:
+    StartupStageMarker menu_and_camera_stage{startup_report, "menu, camera and callbacks"};
+
+  public:
+    [[no_unique_address]] OptionalSystem<InputGraphicsSoundMenu, has_menu> input_graphics_sound_menu;
+    // NOTE: this starts frozen so you have to unfreeze it to look around
+    FPSCamera fps_camera;
+
+    [[no_unique_address]] OptionalSystem<UIRenderSuiteImpl, has_ui_rendering> ui_render_suite;
+
+    /// @param sound_type_to_file only used when the engine has WithSound
+    ComposedToolboxEngine(const std::string &program_name, std::vector<ShaderType> requested_shaders,
+                          std::unordered_map<SoundType, std::string> sound_type_to_file = {})
+        : sound_system_stage(*this,
+                             [&](auto &self) {
+                                 return system_args(self.job_system, self.startup_report, "sound_system",
+                                                    [sound_type_to_file]() {
+                                                        return std::make_unique<SoundSystem>(100, sound_type_to_file);
+                                                    });
+                             }),
+          requested_resolution(extract_width_height_from_resolution(
+                                   configuration.get_value("graphics", "resolution").value_or("1280x720"))
+                                   .value_or(default_resolution)),
+          window(requested_resolution.first, requested_resolution.second, program_name,
+                 get_user_on_off_value_or_default(configuration, "graphics", "fullscreen"), false, false),
+          glfw_lambda_callback_manager(window.glfw_window), requested_shaders(requested_shaders),
+          shader_cache(requested_shaders), batcher(*this, [](auto &self) { return system_args(self.shader_cache); }),
+          sound_system_wait_stage(*this,
+                                  [](auto &self) {
+                                      return system_args(self.startup_report, "waiting for sound_system",
+                                                         self.sound_system_stage);
+                                  }),
+          sound_type_to_file(sound_type_to_file),
+          sound_streamer(*this, [](auto &) { return system_args(); }),
+          input_graphics_sound_menu(*this,
+                                    [](auto &self) {
+                                        return system_args(self.window, self.input_state, self.batcher,
+                                                           self.get_sound_system(), self.configuration);
+                                    }),
+          fps_camera(window.width_px, window.height_px),
+          ui_render_suite(*this, [](auto &self) { return system_args(self.batcher); }) {
+        auto all_callbacks = create_default_glcm_for_input_and_camera(glfw_input_adapter, fps_camera, window,
+                                                                      shader_cache, &input_recorder, &input_replay,
+                                                                      &input_event_queue);
+        glfw_lambda_callback_manager.set_all_callbacks(all_callbacks);
+        glfw_lambda_callback_manager.register_all_callbacks_with_glfw();
+
+        fps_camera.freeze_camera();
+        register_input_graphics_sound_config_handlers(config_handlers, fps_camera, main_loop, frame_pacer);
+        if constexpr (has_batcher) {
+            // NOTE: this is required to draw anything with the batcher's colored vertex shader, eg the menu and hud
+            shader_cache.register_shader_program(ShaderType::ABSOLUTE_POSITION_WITH_COLORED_VERTEX);
+        }
+        startup_report.begin_main_thread_stage("apply_config_logic");
+        configuration.apply_config_logic();
+        fps_camera.set_cursor_position = [&](double xpos, double ypos) { window.set_cursor_pos(xpos, ypos); };
+        on_cursor_pos = [&](double xpos, double ypos) { fps_camera.mouse_callback(xpos, ypos); };
+        get_window_activity = [&]() {
+            bool menu_open = false;
+            if constexpr (has_menu) {
+                menu_open = input_graphics_sound_menu.enabled;
+            }
+            return WindowActivity{glfwGetWindowAttrib(window.glfw_window, GLFW_ICONIFIED) != 0,
+                                  glfwGetWindowAttrib(window.glfw_window, GLFW_FOCUSED) != 0, menu_open};
+        };
+        wait_for_window_events_while_throttled();
+        startup_report.finish();
+        logger.info(startup_report.to_string());
+    }
+
+    /// waits for the sound system if it is still loading in the background
+    SoundSystem &get_sound_system()
+        requires has_sound
+    {
+        return sound_system_stage.get();
+    }
+
+    vertex_geometry::Rectangle get_fullscreen_rect() {
+        auto [carsx, carsy] = window.get_corrective_aspect_ratio_scale();
+        vertex_geometry::Rectangle full_screen_rect(glm_utils::zero_R3, 2 * carsx, 2 * carsy);
+        return full_screen_rect;
+    }
+
+    enum class ActiveMouseMode {
+        CameraControl,  // Mouse moves the camera
+        MenuInteraction // Mouse interacts with UI menus
+    };
+
+    ActiveMouseMode active_mouse_mode = ActiveMouseMode::MenuInteraction;
+
+    // NOTE: must be called every frame so that it updates instantly
+    void update_active_mouse_mode(bool any_mouse_interactable_window_open) {
+        bool all_mouse_interactable_menus_closed = not any_mouse_interactable_window_open;
+        if (all_mouse_interactable_menus_closed) {
+            if (active_mouse_mode == ActiveMouseMode::MenuInteraction) {
+                fps_camera.unfreeze_camera();
+                window.disable_cursor();
+                active_mouse_mode = ActiveMouseMode::CameraControl;
+            }
+        } else {
+            if (active_mouse_mode == ActiveMouseMode::CameraControl) {
+                fps_camera.freeze_camera();
+                window.enable_cursor();
+                active_mouse_mode = ActiveMouseMode::MenuInteraction;
+            }
+        }
+    };
+
+    /**
+     * @brief must be called to render the menu
+     *
+     * @note while the menu is closed this costs an escape check, while it's open the menu processes input and queues
+     * every element each frame, the elements and their geometry live in input_graphics_sound_menu and
+     * ui_render_suite_implementation, so keeping unchanged elements' geometry between frames has to be done there, see
+     * the readme
+     */
+    void process_and_queue_render_input_graphics_sound_menu()
+        requires has_menu
+    {
+        AsyncLogScope _(async_logger, frame_log_section, "process_and_queue_render_input_graphics_sound_menu");
+        TBX_PROFILE_SCOPE("process_and_queue_render_input_graphics_sound_menu");
+
+        if (input_graphics_sound_menu.enabled) {
+            input_graphics_sound_menu.process_and_queue_render_menu(window, input_state, ui_render_suite);
+        }
+
+        // NOTE: escape only opens the menu if no other menu is open ie camera control is on
+        if (input_state.is_just_pressed(EKey::ESCAPE)) {
+            bool menu_was_active = input_graphics_sound_menu.enabled;
+            input_graphics_sound_menu.enabled = active_mouse_mode == ActiveMouseMode::CameraControl;
+            // NOTE: only the transitions are logged, logging every frame the menu is open was a measurable cost
+            if (input_graphics_sound_menu.enabled != menu_was_active) {
+                async_logger.log(frame_log_section, LogLevel::info, "igs menu {}",
+                                 input_graphics_sound_menu.enabled ? "opened" : "closed");
+            }
+        }
+    }
+
+    // NOTE: this had to be named this to avoid a collidion with process_and_queue_rener_ui because UI doesn't use a
+    // namespace, and it should so fix that later
+    /// @note like the menu this is immediate mode, process_and_queue_render_ui handles the input and queues every
+    /// element of ui each call, so its cost is set by the ui subprojects rather than the engine
+    void process_and_queue_render_specific_ui(UI &ui)
+        requires has_ui_rendering
+    {
+        TBX_PROFILE_SCOPE("process_and_queue_render_specific_ui");
+
+        glm::vec2 acnmp = glm_utils::tuple_to_vec2(
+            window.convert_point_from_2d_screen_space_to_2d_aspect_corrected_normalized_screen_space(
+                input_state.mouse_position_x, input_state.mouse_position_y));
+
+        process_and_queue_render_ui(acnmp, ui, ui_render_suite, input_state.get_keys_just_pressed_this_tick(),
+                                    input_state.is_just_pressed(EKey::BACKSPACE),
+                                    input_state.is_just_pressed(EKey::ENTER),
+                                    input_state.is_just_pressed(EKey::LEFT_MOUSE_BUTTON));
+    }
+
+    /**
+     *  @brief draws the stats about the engine that the user has requested to see
+     */
+    void draw_chosen_engine_stats()
+        requires has_batcher
+    {
+        if (show_fps.get()) {
+            draw_fps();
+        }
+        if (show_pos.get()) {
+            draw_pos();
+        }
+        if (show_main_loop_iteration_count.get()) {
+            draw_iteration_count();
+        }
+    }
+
+    ConfigHandle<bool> &show_fps = config_handlers.bind_on_off("graphics", "show_fps", false);
+    ConfigHandle<bool> &show_pos = config_handlers.bind_on_off("graphics", "show_pos", false);
+    ConfigHandle<bool> &show_main_loop_iteration_count =
+        config_handlers.bind_on_off("graphics", "show_main_loop_iteration_count", false);
+
+    EngineStatsHUD engine_stats_hud;
+
+    /**
+     * computes the visible volume of an absolute position shader, these all account for aspect ratio, and thus it
+     * is used here
+     *
+     * also we can use an aabb because the abs position shader doesn't use any perspective so its not a frustum or
+     * something like that
+     */
+    vertex_geometry::AxisAlignedBoundingBox get_visible_aabb_of_absolute_position_shader() {
+        auto [x_scale, y_scale] = window.get_corrective_aspect_ratio_scale();
+        glm::vec3 scale_vec{x_scale, y_scale, 1};
+        glm::vec3 min_corner = glm_utils::minus_one_R3 * scale_vec;
+        glm::vec3 max_corner = glm_utils::one_R3 * scale_vec;
+        return vertex_geometry::AxisAlignedBoundingBox(min_corner, max_corner);
+    }
+
+    /// culls every object in frustum_culler against what fps_camera currently sees, call it once per tick after the
+    /// camera has moved and before queueing draws
+    void cull_against_fps_camera() {
+        TBX_PROFILE_SCOPE("cull_against_fps_camera");
+        frustum_culler.cull(
+            Frustum::from_projection_view(fps_camera.get_projection_matrix() * fps_camera.get_view_matrix()));
+    }
+
+    /// forwards to shader_batcher.queue_draw only when the object passed the last cull, eg
+    /// queue_draw_if_visible(batcher.absolute_position_with_colored_vertex_shader_batcher, id, ivpc)
+    template <typename ShaderBatcher, typename... QueueDrawArgs>
+    bool queue_draw_if_visible(ShaderBatcher &shader_batcher, CullObjectId id, QueueDrawArgs &&...queue_draw_args)
+        requires has_batcher
+    {
+        if (not frustum_culler.is_visible(id)) {
+            return false;
+        }
+        shader_batcher.queue_draw(std::forward<QueueDrawArgs>(queue_draw_args)...);
+        return true;
+    }
+
+    void draw_fps()
+        requires has_batcher
+    {
+        AsyncLogScope _(async_logger, frame_log_section, "draw_fps");
+        TBX_PROFILE_SCOPE("draw_fps");
+        auto top_right = get_visible_aabb_of_absolute_position_shader().get_max_xy_position();
+        batcher.absolute_position_with_colored_vertex_shader_batcher.queue_draw(
+            engine_stats_hud.update_fps_text(frame_arena, main_loop.average_fps.get(), top_right));
+    }
+
+    void draw_iteration_count()
+        requires has_batcher
+    {
+        AsyncLogScope _(async_logger, frame_log_section, "draw_iteration_count");
+        TBX_PROFILE_SCOPE("draw_iteration_count");
+        auto top_right = get_visible_aabb_of_absolute_position_shader().get_max_xy_position();
+        batcher.absolute_position_with_colored_vertex_shader_batcher.queue_draw(
+            engine_stats_hud.update_iteration_count_text(frame_arena, static_cast<long long>(main_loop.iteration_count),
+                                                         top_right));
+    }
+
+    void draw_pos()
+        requires has_batcher
+    {
+        AsyncLogScope _(async_logger, frame_log_section, "draw_pos");
+        TBX_PROFILE_SCOPE("draw_pos");
+        auto top_right = get_visible_aabb_of_absolute_position_shader().get_max_xy_position();
+        batcher.absolute_position_with_colored_vertex_shader_batcher.queue_draw(
+            engine_stats_hud.update_pos_text(frame_arena, fps_camera.transform.get_translation(), top_right));
+    }
+
+    void update_camera_position_with_default_movement(double dt) {
+        auto pressed = action_bindings.get_pressed_actions(input_state);
+        fps_camera.update_position_based_on_keys_pressed(ActionBindings::is_set(pressed, MovementAction::slow_move),
+                                                         ActionBindings::is_set(pressed, MovementAction::fast_move),
+                                                         ActionBindings::is_set(pressed, MovementAction::forward),
+                                                         ActionBindings::is_set(pressed, MovementAction::left),
+                                                         ActionBindings::is_set(pressed, MovementAction::back),
+                                                         ActionBindings::is_set(pressed, MovementAction::right),
+                                                         ActionBindings::is_set(pressed, MovementAction::up),
+                                                         ActionBindings::is_set(pressed, MovementAction::down),
+                                                         dt);
+    }
+
+    /**
+     * @brief Enables standard alpha blending in OpenGL.
+     *
+     * This function enables OpenGL's blending mode and configures it to use
+     * standard alpha transparency. When enabled, fragment colors are combined
+     * with existing framebuffer colors based on their alpha values, allowing
+     * for proper rendering of transparent textures and materials.
+     *
+     * The blending equation used is:
+     *     final_color = src_color * src_alpha + dst_color * (1 - src_alpha)
+     *
+     * This is the most common setup for rendering textures with transparency,
+     * such as UI elements, sprites, or decals.
+     *
+     * Example:
+     * @code
+     * enable_blending();
+     * draw_transparent_object();
+     * @endcode
+     */
+    void enable_blending() {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+};
+
+/// a window, camera and batcher, for tools that draw but need no audio device, menu or ui
+using ToolToolboxEngine = ComposedToolboxEngine<WithBatcher>;
+
+/// everything ToolboxEngine has except the audio device and the menu which depends on it
+using SilentToolboxEngine = ComposedToolboxEngine<WithBatcher, WithUIRendering>;
+
+} // namespace tbx_engine
+
+/**
+ * @brief the engine with every system, a 3d interactive experience that has a 3d component and a 2d menu component
+ *
+ * see ComposedToolboxEngine for everything it does, this only adds the names it has always had for the sound system
+ * and whether the menu is open
+ */
+class ToolboxEngine : public tbx_engine::ComposedToolboxEngine<tbx_engine::WithBatcher, tbx_engine::WithUIRendering,
+                                                               tbx_engine::WithSound, tbx_engine::WithMenu> {
+  public:
+    ToolboxEngine(const std::string &program_name, std::vector<ShaderType> requested_shaders,
+                  std::unordered_map<SoundType, std::string> sound_type_to_file)
+        : ComposedToolboxEngine(program_name, std::move(requested_shaders), std::move(sound_type_to_file)) {}
+
+    SoundSystem &sound_system = get_sound_system();
+    bool &igs_menu_active = input_graphics_sound_menu.enabled;
+};
+
+#endif // COMPOSED_TOOLBOX_ENGINE_HPP
@@ -0,0 +1,70 @@
+#include "config_handles.hpp"
+#include "toolbox_engine.hpp"
+
+namespace tbx_engine {
+
+void ConfigHandlerRegistry::register_config_handler(const std::string &section, const std::string &key,
+                                                    ConfigHandler handler) {
+    auto section_key = std::make_pair(section, key);
+    bool first_handler_for_key = section_key_to_handlers.count(section_key) == 0;
+    section_key_to_handlers[section_key].push_back(std::move(handler));
+
+    // NOTE: the configuration only gets one handler per key, which fans out to every handler registered here
+    if (first_handler_for_key) {
+        configuration.register_config_handler(section, key, [this, section_key](const std::string value) {
+            for (const auto &handler : section_key_to_handlers.at(section_key)) {
+                handler(value);
+            }
+        });
+    }
+}
+
+void ConfigHandlerRegistry::apply_config_logic_for_key(const std::string &section, const std::string &key) {
+    auto it = section_key_to_handlers.find({section, key});
+    if (it == section_key_to_handlers.end()) {
+        return;
+    }
+    std::optional<std::string> value = configuration.get_value(section, key);
+    if (not value.has_value()) {
+        return;
+    }
+    for (const auto &handler : it->second) {
+        handler(*value);
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> ConfigHandlerRegistry::get_keys_with_handlers() const {
+    std::vector<std::pair<std::string, std::string>> keys;
+    keys.reserve(section_key_to_handlers.size());
+    for (const auto &[section_key, handlers] : section_key_to_handlers) {
+        keys.push_back(section_key);
+    }
+    return keys;
+}
+
+ConfigHandle<bool> &ConfigHandlerRegistry::bind_on_off(const std::string &section, const std::string &key,
+                                                       bool default_value) {
+    return bind<bool>(section, key, default_value, [](const std::string &text, ConfigHandle<bool> &handle) {
+        handle.set(parse_on_off_to_bool(text));
+    });
+}
+
+ConfigHandle<int> &ConfigHandlerRegistry::bind_int(const std::string &section, const std::string &key,
+                                                   int default_value) {
+    return bind<int>(section, key, default_value, [](const std::string &text, ConfigHandle<int> &handle) {
+        handle.set(parse_int_or_default(text, handle.get_default_value()));
+    });
+}
+
+ConfigHandle<float> &ConfigHandlerRegistry::bind_float(const std::string &section, const std::string &key,
+                                                       float default_value) {
+    return bind<float>(section, key, default_value, [](const std::string &text, ConfigHandle<float> &handle) {
+        try {
+            handle.set(std::stof(text));
+        } catch (const std::exception &) {
+            handle.set(handle.get_default_value());
+        }
+    });
+}
+
+} // namespace tbx_engine
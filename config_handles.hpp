@@ -0,0 +1,110 @@
+#ifndef CONFIG_HANDLES_HPP
+#define CONFIG_HANDLES_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tbx_engine {
+
+/**
+ * @brief a config value that has already been parsed into its type, reading it is a single load
+ *
+ * handles are created by a ConfigHandlerRegistry which keeps them up to date whenever their key is applied
+ */
+template <typename T> class ConfigHandle {
+  public:
+    explicit ConfigHandle(T default_value) : default_value(default_value), value(default_value) {}
+
+    const T &get() const { return value; }
+    const T &get_default_value() const { return default_value; }
+
+    void set(const T &new_value) { value = new_value; }
+
+  private:
+    T default_value;
+    T value;
+};
+
+/**
+ * @brief registers config handlers with a Configuration while also remembering them, so that a single key can be
+ * re-applied on its own, eg when the config file changes on disk, and so that one key can have many handlers
+ *
+ * @note every handler for a key that goes through the registry is called in registration order when that key is
+ * applied, handlers registered on the Configuration directly for the same key are not seen by the registry
+ */
+class ConfigHandlerRegistry {
+  public:
+    using ConfigHandler = std::function<void(const std::string)>;
+
+    explicit ConfigHandlerRegistry(Configuration &configuration) : configuration(configuration) {}
+
+    ConfigHandlerRegistry(const ConfigHandlerRegistry &) = delete;
+    ConfigHandlerRegistry &operator=(const ConfigHandlerRegistry &) = delete;
+
+    /// has the same signature as Configuration::register_config_handler so either can be used to register handlers
+    void register_config_handler(const std::string &section, const std::string &key, ConfigHandler handler);
+
+    bool has_handlers(const std::string &section, const std::string &key) const {
+        return section_key_to_handlers.count({section, key}) > 0;
+    }
+
+    /// every section and key that has at least one handler, in sorted order
+    std::vector<std::pair<std::string, std::string>> get_keys_with_handlers() const;
+
+    /// runs every handler of this key with the key's current value in the configuration
+    void apply_config_logic_for_key(const std::string &section, const std::string &key);
+
+    ConfigHandle<bool> &bind_on_off(const std::string &section, const std::string &key, bool default_value);
+    ConfigHandle<int> &bind_int(const std::string &section, const std::string &key, int default_value);
+    ConfigHandle<float> &bind_float(const std::string &section, const std::string &key, float default_value);
+
+    /// values that are not in string_to_value leave the handle unchanged
+    template <typename Enum>
+    ConfigHandle<Enum> &bind_enum(const std::string &section, const std::string &key,
+                                  std::unordered_map<std::string, Enum> string_to_value, Enum default_value) {
+        return bind<Enum>(section, key, default_value,
+                          [string_to_value](const std::string &text, ConfigHandle<Enum> &handle) {
+                              auto it = string_to_value.find(text);
+                              if (it != string_to_value.end()) {
+                                  handle.set(it->second);
+                              }
+                          });
+    }
+
+  private:
+    template <typename T>
+    ConfigHandle<T> &bind(const std::string &section, const std::string &key, T default_value,
+                          std::function<void(const std::string &, ConfigHandle<T> &)> parse_into) {
+        auto handle = std::make_shared<ConfigHandle<T>>(default_value);
+        handles.push_back(handle);
+
+        // NOTE: the handle is correct immediately, not only after the config logic is next applied
+        std::optional<std::string> current_value = configuration.get_value(section, key);
+        if (current_value.has_value()) {
+            parse_into(*current_value, *handle);
+        }
+
+        ConfigHandle<T> *handle_ptr = handle.get();
+        register_config_handler(section, key, [handle_ptr, parse_into](const std::string value) {
+            parse_into(value, *handle_ptr);
+        });
+        return *handle;
+    }
+
+    Configuration &configuration;
+    std::map<std::pair<std::string, std::string>, std::vector<ConfigHandler>> section_key_to_handlers;
+    // NOTE: stored type erased so handles of every type live in one place and keep stable addresses
+    std::deque<std::shared_ptr<void>> handles;
+};
+
+} // namespace tbx_engine
+
+#endif // CONFIG_HANDLES_HPP
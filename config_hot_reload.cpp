@@ -0,0 +1,137 @@
+#include "config_hot_reload.hpp"
+
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace tbx_engine {
+
+ConfigFileWatcher::ConfigFileWatcher(const std::string &file_path) : file_path(file_path) {
+    std::error_code error_code;
+    last_write_time = std::filesystem::last_write_time(this->file_path, error_code);
+
+#ifdef __linux__
+    std::filesystem::path directory = this->file_path.parent_path();
+    if (directory.empty()) {
+        directory = ".";
+    }
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd >= 0 and inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(inotify_fd);
+        inotify_fd = -1;
+    }
+#endif
+}
+
+ConfigFileWatcher::~ConfigFileWatcher() {
+#ifdef __linux__
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+    }
+#endif
+}
+
+bool ConfigFileWatcher::has_changed() {
+#ifdef __linux__
+    if (inotify_fd >= 0) {
+        bool changed = false;
+        alignas(inotify_event) char buffer[4096];
+        ssize_t num_bytes_read;
+        // NOTE: every pending event is drained so that one save which produces several events is reported once
+        while ((num_bytes_read = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+            for (char *ptr = buffer; ptr < buffer + num_bytes_read;) {
+                auto *event = reinterpret_cast<inotify_event *>(ptr);
+                if (event->len > 0 and file_path.filename() == event->name) {
+                    changed = true;
+                }
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+        return changed;
+    }
+#endif
+
+    std::error_code error_code;
+    auto write_time = std::filesystem::last_write_time(file_path, error_code);
+    if (error_code or write_time == last_write_time) {
+        return false;
+    }
+    last_write_time = write_time;
+    return true;
+}
+
+std::optional<ConfigHotReloader::FileState> ConfigHotReloader::get_file_state(const std::string &file_path) {
+    std::error_code error_code;
+    std::uintmax_t size = std::filesystem::file_size(file_path, error_code);
+    if (error_code) {
+        return std::nullopt;
+    }
+    std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(file_path, error_code);
+    if (error_code) {
+        return std::nullopt;
+    }
+    return FileState{size, last_write_time};
+}
+
+ConfigHotReloader::ConfigHotReloader(Configuration &configuration, ConfigHandlerRegistry &config_handlers,
+                                     const std::string &file_path)
+    : configuration(configuration), config_handlers(config_handlers), file_path(file_path), file_watcher(file_path),
+      last_check_time(std::chrono::steady_clock::now()) {}
+
+std::vector<SectionKey> ConfigHotReloader::poll() {
+    std::vector<SectionKey> changed_keys;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_check_time < min_check_interval) {
+        return changed_keys;
+    }
+    last_check_time = now;
+
+    if (file_watcher.has_changed()) {
+        reload_pending = true;
+        pending_file_state = std::nullopt;
+    }
+    if (not reload_pending) {
+        return changed_keys;
+    }
+
+    // NOTE: an editor can still be writing when the change is seen, the file is only read once it stopped changing
+    std::optional<FileState> file_state = get_file_state(file_path);
+    if (not file_state.has_value() or file_state != pending_file_state) {
+        pending_file_state = file_state;
+        return changed_keys;
+    }
+    reload_pending = false;
+
+    // NOTE: read with the same parser the engine's configuration was loaded with, so a value means the same thing
+    // here as it did at startup
+    Configuration saved_configuration(file_path);
+    std::vector<std::pair<SectionKey, std::string>> changed_values;
+    bool any_key_in_file = false;
+    for (const SectionKey &section_key : config_handlers.get_keys_with_handlers()) {
+        std::optional<std::string> saved_value = saved_configuration.get_value(section_key.first, section_key.second);
+        if (not saved_value.has_value()) {
+            continue;
+        }
+        any_key_in_file = true;
+        if (configuration.get_value(section_key.first, section_key.second) != saved_value) {
+            changed_values.emplace_back(section_key, std::move(*saved_value));
+        }
+    }
+    // NOTE: most likely the file was emptied while saving and never written again, keeping the old values is safer
+    if (not any_key_in_file) {
+        return changed_keys;
+    }
+
+    for (auto &[section_key, value] : changed_values) {
+        configuration.set_value(section_key.first, section_key.second, value);
+        config_handlers.apply_config_logic_for_key(section_key.first, section_key.second);
+        changed_keys.push_back(section_key);
+    }
+    return changed_keys;
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,95 @@
+#ifndef CONFIG_HOT_RELOAD_HPP
+#define CONFIG_HOT_RELOAD_HPP
+
+#include "config_handles.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tbx_engine {
+
+using SectionKey = std::pair<std::string, std::string>;
+
+/**
+ * @brief tells you when a file was written to without having to read it
+ *
+ * on linux the directory holding the file is watched with inotify, so checking costs a single non blocking read, the
+ * directory is watched rather than the file because most editors save by writing a new file and renaming it over the
+ * old one, elsewhere, or if inotify isn't available, the file's modification time is compared instead
+ *
+ */
+class ConfigFileWatcher {
+  public:
+    explicit ConfigFileWatcher(const std::string &file_path);
+    ~ConfigFileWatcher();
+
+    ConfigFileWatcher(const ConfigFileWatcher &) = delete;
+    ConfigFileWatcher &operator=(const ConfigFileWatcher &) = delete;
+
+    /// @return true if the file changed since the last call
+    bool has_changed();
+
+    bool is_using_inotify() const { return inotify_fd >= 0; }
+
+  private:
+    std::filesystem::path file_path;
+    int inotify_fd = -1;
+    std::filesystem::file_time_type last_write_time;
+};
+
+/**
+ * @brief re-applies the config file while the engine is running whenever it is saved
+ *
+ * the saved file is read with Configuration's own parser and every key that has handlers in the ConfigHandlerRegistry
+ * is compared against the value the running configuration holds, only the keys whose value differs are written into
+ * the configuration and have their handlers run, so saving the file with a new max_fps only touches the main loop
+ *
+ * the running configuration is the baseline, it holds what was read when the engine was constructed, and the first
+ * poll compares against the file even if no change was seen, so an edit made between constructing the engine and
+ * creating the reloader is picked up too
+ *
+ * a change is only read once the file's size and modification time were the same on two checks in a row, so a file
+ * that an editor is still writing isn't read half written, which delays a reload by one min_check_interval
+ *
+ * @note keys that are removed from the file keep their current value, keys without handlers in the registry aren't
+ * reloaded, and neither are handlers registered on the Configuration directly, eg through the Configuration &
+ * overloads of the register_*_config_handlers functions, since the registry never sees them
+ */
+class ConfigHotReloader {
+  public:
+    ConfigHotReloader(Configuration &configuration, ConfigHandlerRegistry &config_handlers,
+                      const std::string &file_path);
+
+    /// the file is checked at most this often, so calling poll every tick is cheap
+    std::chrono::milliseconds min_check_interval{250};
+
+    /// @return the keys that changed and were re-applied, usually empty
+    std::vector<SectionKey> poll();
+
+  private:
+    struct FileState {
+        std::uintmax_t size;
+        std::filesystem::file_time_type last_write_time;
+        bool operator==(const FileState &other) const = default;
+    };
+    static std::optional<FileState> get_file_state(const std::string &file_path);
+
+    Configuration &configuration;
+    ConfigHandlerRegistry &config_handlers;
+    std::string file_path;
+    ConfigFileWatcher file_watcher;
+    /// set when the watcher saw a change that hasn't been read yet, starts out set, see the class comment
+    bool reload_pending = true;
+    /// the file's state on the last check since the change, std::nullopt right after a change
+    std::optional<FileState> pending_file_state;
+    std::chrono::steady_clock::time_point last_check_time;
+};
+
+} // namespace tbx_engine
+
+#endif // CONFIG_HOT_RELOAD_HPP
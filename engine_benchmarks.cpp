@@ -0,0 +1,128 @@
+#include "engine_benchmarks.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+namespace tbx_engine {
+
+std::vector<BenchmarkResult> run_engine_benchmarks(HeadlessToolboxEngine &engine) {
+    std::vector<BenchmarkResult> results;
+
+    InputState &input_state = engine.input_state;
+    Configuration &configuration = engine.configuration;
+
+    results.push_back(run_benchmark("get_input_key_from_config_or_default_value", [&] {
+        do_not_optimize(get_input_key_from_config_or_default_value(input_state, configuration, config_value_forward));
+    }));
+
+    results.push_back(run_benchmark("get_god_mode_movement_input (string lookups)", [&] {
+        for (const auto &config_value : movement_action_to_config_value) {
+            do_not_optimize(input_state.is_pressed(
+                get_input_key_from_config_or_default_value(input_state, configuration, config_value)));
+        }
+    }));
+
+    results.push_back(run_benchmark("get_god_mode_movement_input (action bindings)",
+                                    [&] { do_not_optimize(engine.get_god_mode_movement_input()); }));
+
+    results.push_back(run_benchmark("draw_chosen_engine_stats is_on checks", [&] {
+        do_not_optimize(configuration.is_on("graphics", "show_fps"));
+        do_not_optimize(configuration.is_on("graphics", "show_pos"));
+        do_not_optimize(configuration.is_on("graphics", "show_main_loop_iteration_count"));
+    }));
+
+    // NOTE: reading a handle costs the same whether or not it is bound, these aren't bound to the registry because
+    // every run of the benchmarks would leave three more handlers on the engine's keys
+    ConfigHandle<bool> show_fps(configuration.is_on("graphics", "show_fps"));
+    ConfigHandle<bool> show_pos(configuration.is_on("graphics", "show_pos"));
+    ConfigHandle<bool> show_main_loop_iteration_count(
+        configuration.is_on("graphics", "show_main_loop_iteration_count"));
+    results.push_back(run_benchmark("draw_chosen_engine_stats config handles", [&] {
+        do_not_optimize(show_fps.get());
+        do_not_optimize(show_pos.get());
+        do_not_optimize(show_main_loop_iteration_count.get());
+    }));
+
+    glm::vec3 top_right(1, 1, 0);
+    float side_length = 0.2;
+    vertex_geometry::Rectangle fps_rect =
+        vertex_geometry::create_rectangle_from_top_right(top_right, side_length, side_length);
+
+    // NOTE: what draw_fps did before its geometry was cached, kept as the baseline for the ones below
+    results.push_back(run_benchmark("draw_fps geometry (uncached grid_font)", [&] {
+        do_not_optimize(draw_info::IVPColor(grid_font::get_text_geometry(std::to_string(144), fps_rect), colors::grey));
+    }));
+
+    // NOTE: these call the same EngineStatsHUD updates that draw_fps and draw_pos do, the arena is reset after each
+    // call the way the main loop resets it after each tick
+    EngineStatsHUD engine_stats_hud;
+    FrameArena hud_frame_arena;
+    results.push_back(run_benchmark("draw_fps geometry (unchanged text)", [&] {
+        do_not_optimize(engine_stats_hud.update_fps_text(hud_frame_arena, 144, top_right));
+        hud_frame_arena.reset();
+    }));
+
+    int fake_fps = 0;
+    results.push_back(run_benchmark("draw_fps geometry (changing text)", [&] {
+        fake_fps = (fake_fps + 1) % 1000;
+        do_not_optimize(engine_stats_hud.update_fps_text(hud_frame_arena, fake_fps, top_right));
+        hud_frame_arena.reset();
+    }));
+
+    float fake_x = 0;
+    results.push_back(run_benchmark("draw_pos geometry (moving)", [&] {
+        fake_x += 0.01;
+        glm::vec3 pos(fake_x, 1.5, -3.25);
+        do_not_optimize(engine_stats_hud.update_pos_text(hud_frame_arena, pos, top_right));
+        hud_frame_arena.reset();
+    }));
+
+    results.push_back(run_benchmark("extract_width_height_from_resolution",
+                                    [&] { do_not_optimize(extract_width_height_from_resolution("1920x1080")); }));
+
+    // NOTE: each call to start runs a fixed number of ticks, the per tick cost is reported
+    const std::size_t num_ticks_per_start = 1000;
+    std::optional<double> previous_target_rate_hz = engine.frame_pacer.get_target_rate_hz();
+    // NOTE: the governor would otherwise pace the ticks back to max_fps and this would measure the wait
+    bool previous_governor_enabled = engine.frame_rate_governor.enabled;
+    engine.frame_rate_governor.enabled = false;
+    // NOTE: otherwise the first tick sets up the config file watch and every tick after polls it
+    bool previous_hot_reload_config = engine.hot_reload_config;
+    engine.hot_reload_config = false;
+    engine.frame_rate_governor.set_full_rate_hz(std::nullopt);
+    engine.frame_pacer.set_target_rate_hz(std::nullopt);
+    configure_main_loop_pacing(engine.main_loop, engine.frame_pacer);
+    BenchmarkResult headless_tick = run_benchmark("headless tick", [&] {
+        std::size_t ticks_run = 0;
+        engine.start([&](double dt) { do_not_optimize(dt); },
+                     [&]() { return ticks_run++ >= num_ticks_per_start; });
+    });
+    headless_tick.num_iterations *= num_ticks_per_start;
+    headless_tick.ns_per_op /= num_ticks_per_start;
+    headless_tick.allocations_per_op /= num_ticks_per_start;
+    results.push_back(headless_tick);
+    engine.frame_rate_governor.set_full_rate_hz(previous_target_rate_hz);
+    engine.frame_rate_governor.enabled = previous_governor_enabled;
+    engine.hot_reload_config = previous_hot_reload_config;
+    engine.frame_pacer.set_target_rate_hz(previous_target_rate_hz);
+    configure_main_loop_pacing(engine.main_loop, engine.frame_pacer);
+
+    return results;
+}
+
+void print_benchmark_results(const std::vector<BenchmarkResult> &results) {
+    std::cout << std::left << std::setw(50) << "benchmark" << std::right << std::setw(14) << "ns/op" << std::setw(14)
+              << "allocs/op" << std::setw(14) << "iterations" << std::endl;
+    for (const auto &result : results) {
+        std::cout << std::left << std::setw(50) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << result.ns_per_op << std::setprecision(2) << std::setw(14);
+        if (allocation_counting_enabled) {
+            std::cout << result.allocations_per_op;
+        } else {
+            std::cout << "n/a";
+        }
+        std::cout << std::setw(14) << result.num_iterations << std::endl;
+    }
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,76 @@
+#ifndef ENGINE_BENCHMARKS_HPP
+#define ENGINE_BENCHMARKS_HPP
+
+#include "allocation_counter.hpp"
+#include "toolbox_engine.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace tbx_engine {
+
+struct BenchmarkResult {
+    std::string name;
+    std::size_t num_iterations;
+    double ns_per_op;
+    /// always zero unless allocation_counting_enabled
+    double allocations_per_op;
+};
+
+/// stops the compiler from optimizing away a value that a benchmark computes but never uses
+template <typename T> inline void do_not_optimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @brief runs op repeatedly until at least min_duration has passed and reports the average cost of a single call
+ *
+ * the iteration count doubles each round so that the clock is read rarely compared to how often op runs
+ */
+template <typename Op>
+BenchmarkResult run_benchmark(const std::string &name, Op &&op,
+                              std::chrono::nanoseconds min_duration = std::chrono::milliseconds(200)) {
+    // NOTE: a warm up call so lazily built caches don't count towards the first round
+    op();
+
+    std::size_t num_iterations = 1;
+    while (true) {
+        std::uint64_t allocations_before = get_num_heap_allocations_on_this_thread();
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < num_iterations; i++) {
+            op();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        std::uint64_t num_allocations = get_num_heap_allocations_on_this_thread() - allocations_before;
+
+        if (elapsed >= min_duration) {
+            double elapsed_ns = std::chrono::duration<double, std::nano>(elapsed).count();
+            return {name, num_iterations, elapsed_ns / num_iterations,
+                    static_cast<double>(num_allocations) / num_iterations};
+        }
+        num_iterations *= 2;
+    }
+}
+
+/**
+ * @brief benchmarks the engine's own per tick work, none of it needs a gpu or audio device
+ *
+ * covers key binding resolution, the on/off checks in draw_chosen_engine_stats, hud text geometry generation,
+ * resolution parsing and a full tick of the headless main loop
+ *
+ * @note the headless tick benchmark temporarily switches the main loop to run as fast as possible with config hot
+ * reloading off and restores both afterwards
+ */
+std::vector<BenchmarkResult> run_engine_benchmarks(HeadlessToolboxEngine &engine);
+
+void print_benchmark_results(const std::vector<BenchmarkResult> &results);
+
+} // namespace tbx_engine
+
+#endif // ENGINE_BENCHMARKS_HPP
@@ -0,0 +1,13 @@
+// NOTE: this is only built into its own executable, so the main is behind a define, otherwise any project that
+// compiles every source file of the engine would get a second main
+#ifdef TBX_ENGINE_BENCHMARKS_MAIN
+
+#include "engine_benchmarks.hpp"
+
+int main() {
+    HeadlessToolboxEngine engine;
+    tbx_engine::print_benchmark_results(tbx_engine::run_engine_benchmarks(engine));
+    return 0;
+}
+
+#endif // TBX_ENGINE_BENCHMARKS_MAIN
@@ -0,0 +1,21 @@
+#include "engine_checks.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+namespace tbx_engine {
+
+bool print_check_results(const std::vector<CheckResult> &results) {
+    bool all_passed = true;
+    for (const auto &result : results) {
+        std::cout << (result.passed ? "[pass] " : "[FAIL] ") << std::left << std::setw(60) << result.name;
+        if (not result.detail.empty()) {
+            std::cout << ' ' << result.detail;
+        }
+        std::cout << std::endl;
+        all_passed = all_passed and result.passed;
+    }
+    return all_passed;
+}
+
+} // namespace tbx_engine
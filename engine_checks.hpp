@@ -0,0 +1,44 @@
+#ifndef ENGINE_CHECKS_HPP
+#define ENGINE_CHECKS_HPP
+
+#include <string>
+#include <vector>
+
+namespace tbx_engine {
+
+struct CheckResult {
+    std::string name;
+    bool passed;
+    /// what was measured, eg the two counts that were compared
+    std::string detail;
+};
+
+/**
+ * @brief checks the cpu only culling against hand placed boxes and the sse path against the scalar one
+ *
+ * needs no window, the culler is driven with a projection * view matrix directly
+ */
+std::vector<CheckResult> run_frustum_culling_checks();
+
+/**
+ * @brief replicates entities between a server and a client over loopback, on a perfect network and with simulated
+ * loss, latency and jitter, and checks that the client ends up with what the server has
+ *
+ * takes a few seconds since the ticks run in real time
+ */
+std::vector<CheckResult> run_replication_checks();
+
+/**
+ * @brief decodes wav files in every supported format, runs the sound cache over its budget and plays streams on a
+ * NullSoundOutputDevice, so it needs no audio hardware
+ *
+ * the wav files are written to a directory in the system's temp directory which is removed afterwards
+ */
+std::vector<CheckResult> run_sound_checks();
+
+/// @return true if every check passed
+bool print_check_results(const std::vector<CheckResult> &results);
+
+} // namespace tbx_engine
+
+#endif // ENGINE_CHECKS_HPP
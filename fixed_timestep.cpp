@@ -0,0 +1,33 @@
+#include "fixed_timestep.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tbx_engine {
+
+void FixedTimestep::set_step_rate_hz(double step_rate_hz) {
+    if (step_rate_hz > 0) {
+        // NOTE: the leftover is kept as a fraction of a step so alpha doesn't jump when the rate changes
+        double alpha = get_alpha();
+        step_s = 1 / step_rate_hz;
+        accumulated_s = alpha * step_s;
+    }
+}
+
+int FixedTimestep::advance(double dt) {
+    accumulated_s += std::max(dt, 0.0);
+    int num_steps_now = static_cast<int>(accumulated_s / step_s);
+    if (num_steps_now > max_steps_per_frame) {
+        double excess_s = (num_steps_now - max_steps_per_frame) * step_s;
+        dropped_s += excess_s;
+        accumulated_s -= excess_s;
+        num_steps_now = max_steps_per_frame;
+    }
+    accumulated_s -= num_steps_now * step_s;
+    // NOTE: rounding can leave the leftover a hair outside of [0, step_s)
+    accumulated_s = std::clamp(accumulated_s, 0.0, std::nextafter(step_s, 0.0));
+    num_steps += num_steps_now;
+    return num_steps_now;
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,72 @@
+#ifndef FIXED_TIMESTEP_HPP
+#define FIXED_TIMESTEP_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <cstdint>
+
+namespace tbx_engine {
+
+/**
+ * @brief turns the variable dt of rendered frames into a whole number of simulation steps of a fixed size, whatever is
+ * left over carries over to the next frame
+ *
+ * so the simulation runs at step_rate_hz no matter how fast frames are rendered, a frame rendered faster than that runs
+ * no step at all and one that took longer runs several, if a frame took longer than max_steps_per_frame steps the
+ * rest of that time is dropped, otherwise a slow step would make the next frame slower still
+ *
+ */
+class FixedTimestep {
+  public:
+    explicit FixedTimestep(double step_rate_hz = 60) { set_step_rate_hz(step_rate_hz); }
+
+    /// catching up after a stall is limited to this many steps in one frame
+    int max_steps_per_frame = 5;
+
+    void set_step_rate_hz(double step_rate_hz);
+    double get_step_rate_hz() const { return 1 / step_s; }
+    double get_step_s() const { return step_s; }
+
+    /// adds a frame's dt and returns how many steps to run for it
+    int advance(double dt);
+
+    /// how far the time of the frame is between the last step and the next one, in [0, 1), render with the state
+    /// blended this far from the previous step to the last one
+    double get_alpha() const { return accumulated_s / step_s; }
+
+    std::uint64_t get_num_steps() const { return num_steps; }
+    /// the time dropped because a frame needed more than max_steps_per_frame steps
+    double get_dropped_s() const { return dropped_s; }
+
+    /// forgets the leftover time, eg after loading when the last frame's dt is meaningless
+    void reset() { accumulated_s = 0; }
+
+  private:
+    double step_s = 1.0 / 60;
+    double accumulated_s = 0;
+    std::uint64_t num_steps = 0;
+    double dropped_s = 0;
+};
+
+/// remembers a position at the last two simulation steps so frames rendered in between can blend between them
+class InterpolatedPosition {
+  public:
+    /// jumps straight to position, eg after a teleport, so the next frames don't slide there
+    void reset(const glm::vec3 &position) { previous = current = position; }
+    /// call after every step with where it ended up
+    void push(const glm::vec3 &position) {
+        previous = current;
+        current = position;
+    }
+
+    glm::vec3 get(double alpha) const { return glm::mix(previous, current, static_cast<float>(alpha)); }
+    const glm::vec3 &get_current() const { return current; }
+
+  private:
+    glm::vec3 previous{0};
+    glm::vec3 current{0};
+};
+
+} // namespace tbx_engine
+
+#endif // FIXED_TIMESTEP_HPP
@@ -0,0 +1,78 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+
+namespace tbx_engine {
+
+FrameArena::FrameArena(std::size_t initial_capacity_bytes) {
+    add_block(std::max<std::size_t>(initial_capacity_bytes, 64));
+}
+
+void FrameArena::add_block(std::size_t size_bytes) {
+    blocks.push_back({std::make_unique<std::byte[]>(size_bytes), size_bytes});
+    capacity += size_bytes;
+    num_block_allocations++;
+}
+
+void *FrameArena::allocate(std::size_t size_bytes, std::size_t alignment) {
+    while (true) {
+        Block &block = blocks[current_block_index];
+        auto block_address = reinterpret_cast<std::uintptr_t>(block.data.get());
+        std::size_t aligned_offset = ((block_address + current_block_offset + alignment - 1) & ~(alignment - 1)) -
+                                     block_address;
+
+        if (aligned_offset + size_bytes <= block.size) {
+            bytes_used += aligned_offset + size_bytes - current_block_offset;
+            current_block_offset = aligned_offset + size_bytes;
+            return block.data.get() + aligned_offset;
+        }
+
+        // NOTE: the rest of the current block is given up, it's counted as used so that the merged block made on the
+        // next reset is large enough for the same pattern of allocations
+        bytes_used += block.size - current_block_offset;
+        if (current_block_index + 1 == blocks.size()) {
+            add_block(std::max(block.size * 2, size_bytes + alignment));
+        }
+        current_block_index++;
+        current_block_offset = 0;
+    }
+}
+
+void FrameArena::reset() {
+    high_water_bytes = std::max(high_water_bytes, bytes_used);
+
+    if (blocks.size() > 1) {
+        std::size_t merged_size = capacity;
+        blocks.clear();
+        capacity = 0;
+        add_block(merged_size);
+    }
+
+    current_block_index = 0;
+    current_block_offset = 0;
+    bytes_used = 0;
+}
+
+ArenaString make_arena_string(FrameArena &arena, std::string_view text) {
+    return ArenaString(text, ArenaAllocator<char>(arena));
+}
+
+ArenaString to_arena_string(FrameArena &arena, long long value) {
+    std::array<char, 24> buffer;
+    auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    return make_arena_string(arena, std::string_view(buffer.data(), result.ptr - buffer.data()));
+}
+
+ArenaString to_arena_string(FrameArena &arena, double value, int decimal_places) {
+    std::array<char, 64> buffer;
+    auto result =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, std::chars_format::fixed, decimal_places);
+    if (result.ec != std::errc()) {
+        return make_arena_string(arena, "?");
+    }
+    return make_arena_string(arena, std::string_view(buffer.data(), result.ptr - buffer.data()));
+}
+
+} // namespace tbx_engine
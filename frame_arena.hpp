@@ -0,0 +1,103 @@
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tbx_engine {
+
+/**
+ * @brief a bump allocator for memory that only has to live until the end of the current tick
+ *
+ * allocating is aligning an offset and adding to it, deallocating does nothing and reset hands everything back at once,
+ * when a tick needs more than the arena holds an extra block is allocated from the heap, and the next reset merges all
+ * blocks into a single one big enough for that tick, so after the first few ticks the arena stops touching the heap
+ *
+ * @note not thread safe, the engine's frame arena belongs to the thread running the main loop
+ */
+class FrameArena {
+  public:
+    explicit FrameArena(std::size_t initial_capacity_bytes = 1 << 16);
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /// @param alignment must be a power of two
+    void *allocate(std::size_t size_bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    /// invalidates everything allocated since the last reset
+    void reset();
+
+    /// bytes handed out since the last reset, including alignment padding
+    std::size_t get_bytes_used() const { return bytes_used; }
+    std::size_t get_capacity() const { return capacity; }
+    /// the most bytes used between two resets so far
+    std::size_t get_high_water_bytes() const { return high_water_bytes; }
+    /// the number of times the arena had to go to the heap for another block
+    std::uint64_t get_num_block_allocations() const { return num_block_allocations; }
+
+  private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    void add_block(std::size_t size_bytes);
+
+    std::vector<Block> blocks;
+    std::size_t current_block_index = 0;
+    std::size_t current_block_offset = 0;
+
+    std::size_t capacity = 0;
+    std::size_t bytes_used = 0;
+    std::size_t high_water_bytes = 0;
+    std::uint64_t num_block_allocations = 0;
+};
+
+/**
+ * @brief a standard allocator that takes its memory from a FrameArena, so the usual containers can be used for
+ * per tick scratch data without touching the heap
+ *
+ * @note a container using this must not outlive the tick it was filled in
+ */
+template <typename T> class ArenaAllocator {
+  public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena &arena) : arena(&arena) {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.get_arena()) {}
+
+    T *allocate(std::size_t n) { return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *, std::size_t) {}
+
+    FrameArena *get_arena() const { return arena; }
+
+    template <typename U> bool operator==(const ArenaAllocator<U> &other) const { return arena == other.get_arena(); }
+
+  private:
+    FrameArena *arena;
+};
+
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+template <typename T> ArenaVector<T> make_arena_vector(FrameArena &arena, std::size_t reserved_size = 0) {
+    ArenaVector<T> vector{ArenaAllocator<T>(arena)};
+    vector.reserve(reserved_size);
+    return vector;
+}
+
+ArenaString make_arena_string(FrameArena &arena, std::string_view text = {});
+
+/// like std::to_string but the result lives in the arena
+ArenaString to_arena_string(FrameArena &arena, long long value);
+/// formats with a fixed number of decimal places, eg 1.50 for 1.5 with 2 decimal places
+ArenaString to_arena_string(FrameArena &arena, double value, int decimal_places);
+
+} // namespace tbx_engine
+
+#endif // FRAME_ARENA_HPP
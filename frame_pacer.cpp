@@ -0,0 +1,158 @@
+#include "frame_pacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace tbx_engine {
+
+std::optional<FramePacingStrategy> parse_frame_pacing_strategy(const std::string &text) {
+    if (text == "busy_wait") {
+        return FramePacingStrategy::busy_wait;
+    }
+    if (text == "sleep") {
+        return FramePacingStrategy::sleep;
+    }
+    if (text == "hybrid") {
+        return FramePacingStrategy::hybrid;
+    }
+    return std::nullopt;
+}
+
+void FramePacer::set_target_rate_hz(std::optional<double> rate_hz) {
+    if (rate_hz.has_value() and *rate_hz <= 0) {
+        rate_hz = std::nullopt;
+    }
+    target_rate_hz = rate_hz;
+    if (target_rate_hz.has_value()) {
+        frame_period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / *rate_hz));
+    }
+    has_deadline = false;
+}
+
+void FramePacer::wait_for_next_frame() {
+    if (not target_rate_hz.has_value()) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    if (not has_deadline) {
+        next_deadline = now + frame_period;
+        last_frame_start = now;
+        has_deadline = true;
+        return;
+    }
+
+    if (now < next_deadline) {
+        if (strategy != FramePacingStrategy::busy_wait and sleep_until_close_to(next_deadline)) {
+            // NOTE: an early wake up isn't a missed deadline so it stays out of the stats, the frames after it are
+            // paced from now
+            last_frame_start = Clock::now();
+            next_deadline = last_frame_start + frame_period;
+            return;
+        }
+        if (strategy != FramePacingStrategy::sleep) {
+            spin_until(next_deadline);
+        }
+    }
+
+    Clock::time_point woke_up_at = Clock::now();
+    record_frame(next_deadline, woke_up_at);
+
+    // NOTE: when a tick ran over by more than a whole frame we start counting from now instead of trying to catch up
+    // with a burst of unpaced frames
+    next_deadline += frame_period;
+    if (woke_up_at > next_deadline) {
+        next_deadline = woke_up_at + frame_period;
+    }
+}
+
+bool FramePacer::sleep_for(Clock::duration duration) {
+    if (wait_for_events) {
+        return wait_for_events(std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
+    }
+    std::this_thread::sleep_for(duration);
+    return false;
+}
+
+bool FramePacer::sleep_until_close_to(Clock::time_point deadline) {
+    const auto sleep_step = std::chrono::milliseconds(1);
+
+    while (true) {
+        double remaining_s = std::chrono::duration<double>(deadline - Clock::now()).count();
+        bool sleep_would_overshoot = strategy == FramePacingStrategy::hybrid and remaining_s <= sleep_estimate_s;
+        if (remaining_s <= 0 or sleep_would_overshoot) {
+            return false;
+        }
+
+        Clock::time_point sleep_start = Clock::now();
+        bool woken_early = sleep_for(strategy == FramePacingStrategy::sleep ? deadline - sleep_start : sleep_step);
+        if (woken_early) {
+            return true;
+        }
+        double slept_s = std::chrono::duration<double>(Clock::now() - sleep_start).count();
+        total_sleep_s += slept_s;
+
+        if (strategy == FramePacingStrategy::hybrid) {
+            double delta = slept_s - sleep_mean_s;
+            sleep_mean_s += sleep_estimate_weight * delta;
+            sleep_variance_s2 =
+                (1 - sleep_estimate_weight) * (sleep_variance_s2 + sleep_estimate_weight * delta * delta);
+            sleep_estimate_s = sleep_mean_s + std::sqrt(sleep_variance_s2);
+        } else {
+            return false;
+        }
+    }
+}
+
+void FramePacer::spin_until(Clock::time_point deadline) {
+    Clock::time_point spin_start = Clock::now();
+    while (Clock::now() < deadline) {
+    }
+    total_spin_s += std::chrono::duration<double>(Clock::now() - spin_start).count();
+}
+
+void FramePacer::record_frame(Clock::time_point deadline, Clock::time_point woke_up_at) {
+    double wake_error_us = std::max(0.0, std::chrono::duration<double, std::micro>(woke_up_at - deadline).count());
+    num_frames_paced++;
+    total_wake_error_us += wake_error_us;
+    max_wake_error_us = std::max(max_wake_error_us, wake_error_us);
+
+    double interval_us = std::chrono::duration<double, std::micro>(woke_up_at - last_frame_start).count();
+    last_frame_start = woke_up_at;
+    num_intervals++;
+    double delta = interval_us - interval_mean_us;
+    interval_mean_us += delta / num_intervals;
+    interval_m2 += delta * (interval_us - interval_mean_us);
+}
+
+FramePacingStats FramePacer::get_stats() const {
+    FramePacingStats stats;
+    stats.num_frames_paced = num_frames_paced;
+    if (num_frames_paced > 0) {
+        stats.mean_wake_error_us = total_wake_error_us / num_frames_paced;
+    }
+    stats.max_wake_error_us = max_wake_error_us;
+    if (num_intervals > 1) {
+        stats.frame_interval_jitter_us = std::sqrt(interval_m2 / (num_intervals - 1));
+    }
+    double total_wait_s = total_sleep_s + total_spin_s;
+    if (total_wait_s > 0) {
+        stats.spin_fraction = total_spin_s / total_wait_s;
+    }
+    stats.estimated_sleep_duration_us = sleep_estimate_s * 1e6;
+    return stats;
+}
+
+void FramePacer::reset_stats() {
+    num_frames_paced = 0;
+    total_wake_error_us = 0;
+    max_wake_error_us = 0;
+    interval_mean_us = 0;
+    interval_m2 = 0;
+    num_intervals = 0;
+    total_sleep_s = 0;
+    total_spin_s = 0;
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,107 @@
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace tbx_engine {
+
+/**
+ * @brief how the main loop waits out the rest of a frame once the work of a tick is done
+ *
+ * busy_wait spins for the whole remaining time, it's the most accurate but keeps a core at 100%, sleep only sleeps so
+ * it uses almost no cpu but wakes up late by however much the os oversleeps, hybrid sleeps for most of the remaining
+ * time and spins only for the last slice, which is about as accurate as busy_wait for a fraction of the cpu
+ */
+enum class FramePacingStrategy { busy_wait, sleep, hybrid };
+
+std::optional<FramePacingStrategy> parse_frame_pacing_strategy(const std::string &text);
+
+struct FramePacingStats {
+    std::uint64_t num_frames_paced = 0;
+    /// how far after the deadline each wait actually ended, in microseconds
+    double mean_wake_error_us = 0;
+    double max_wake_error_us = 0;
+    /// the standard deviation of the frame to frame interval, in microseconds
+    double frame_interval_jitter_us = 0;
+    /// the fraction of waiting time that was spent spinning rather than sleeping
+    double spin_fraction = 0;
+    /// the current estimate of how long a 1ms sleep really takes, in microseconds
+    double estimated_sleep_duration_us = 0;
+};
+
+/**
+ * @brief paces the main loop to a target rate using one of the FramePacingStrategy's
+ *
+ * for the hybrid strategy the pacer sleeps in 1ms steps while the remaining time is larger than its estimate of how
+ * long such a sleep really takes, then spins until the deadline, every sleep it does is measured and feeds an
+ * exponentially weighted mean and standard deviation, so the estimate adapts to how much the os oversleeps on this
+ * machine and follows it when that changes, eg when another process raises the system's timer resolution
+ *
+ */
+class FramePacer {
+  public:
+    FramePacingStrategy strategy = FramePacingStrategy::hybrid;
+
+    /// std::nullopt means the loop is not rate limited at all
+    void set_target_rate_hz(std::optional<double> rate_hz);
+    std::optional<double> get_target_rate_hz() const { return target_rate_hz; }
+
+    /// for the engine's main loop busy_wait is left to the FixedFrequencyLoop itself, so the pacer is only in charge of
+    /// the other strategies
+    bool is_pacing() const { return target_rate_hz.has_value() and strategy != FramePacingStrategy::busy_wait; }
+
+    /// blocks until the start of the next frame, call this once at the end of every tick, this supports every strategy
+    /// so loops other than the main loop can be paced with it too
+    void wait_for_next_frame();
+
+    /// forgets the current deadline, eg after the loop was paused, so the next frame doesn't try to catch up
+    void reset_deadline() { has_deadline = false; }
+
+    /// if set the sleeping part of a wait calls this instead of sleeping, it must block for at most the given time and
+    /// return true if the next frame should start right away, eg because input arrived
+    std::function<bool(std::chrono::nanoseconds)> wait_for_events;
+
+    FramePacingStats get_stats() const;
+    void reset_stats();
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    /// @return true if wait_for_events ended the wait early
+    bool sleep_until_close_to(Clock::time_point deadline);
+    /// sleeps for duration, or waits for events if wait_for_events is set
+    bool sleep_for(Clock::duration duration);
+    void spin_until(Clock::time_point deadline);
+    void record_frame(Clock::time_point deadline, Clock::time_point woke_up_at);
+
+    std::optional<double> target_rate_hz;
+    Clock::duration frame_period{};
+    bool has_deadline = false;
+    Clock::time_point next_deadline;
+    Clock::time_point last_frame_start;
+
+    // NOTE: the estimate starts at what a 1ms sleep takes on a typical desktop, starting much higher would mean that
+    // at high rates the remaining time is never above it, no sleep is ever measured and the pacer spins forever
+    double sleep_mean_s = 1.05e-3;
+    double sleep_variance_s2 = 0.05e-3 * 0.05e-3;
+    double sleep_estimate_s = 1.1e-3;
+    /// how much each measured sleep moves the estimate, about the last 16 sleeps are what count
+    static constexpr double sleep_estimate_weight = 1.0 / 16;
+
+    std::uint64_t num_frames_paced = 0;
+    double total_wake_error_us = 0;
+    double max_wake_error_us = 0;
+    double interval_mean_us = 0;
+    double interval_m2 = 0;
+    std::uint64_t num_intervals = 0;
+    double total_sleep_s = 0;
+    double total_spin_s = 0;
+};
+
+} // namespace tbx_engine
+
+#endif // FRAME_PACER_HPP
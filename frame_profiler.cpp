@@ -0,0 +1,169 @@
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+
+namespace tbx_engine {
+
+namespace {
+
+/// hands the ring buffer back to the profiler when its thread exits so short lived threads don't leak buffers
+struct ThreadRingBuffer {
+    ProfileEventRingBuffer *ring_buffer = nullptr;
+    std::uint32_t thread_index = 0;
+
+    ~ThreadRingBuffer() {
+        if (ring_buffer != nullptr) {
+            get_frame_profiler().release_ring_buffer(thread_index);
+        }
+    }
+};
+
+thread_local ThreadRingBuffer this_threads_ring_buffer;
+
+double percentile_of_sorted(const std::vector<double> &sorted_values, double percentile) {
+    if (sorted_values.empty()) {
+        return 0;
+    }
+    std::size_t index = static_cast<std::size_t>(percentile * (sorted_values.size() - 1) + 0.5);
+    return sorted_values[std::min(index, sorted_values.size() - 1)];
+}
+
+void write_json_escaped(std::ofstream &out, const char *text) {
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '"' or *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+}
+
+} // namespace
+
+FrameProfiler &get_frame_profiler() {
+    static FrameProfiler frame_profiler;
+    return frame_profiler;
+}
+
+ProfileEventRingBuffer &FrameProfiler::get_ring_buffer_for_this_thread() {
+    if (this_threads_ring_buffer.ring_buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(ring_buffers_mutex);
+        if (free_ring_buffer_indices.empty()) {
+            ring_buffers.push_back(std::make_unique<ProfileEventRingBuffer>());
+            this_threads_ring_buffer.thread_index = ring_buffers.size() - 1;
+        } else {
+            this_threads_ring_buffer.thread_index = free_ring_buffer_indices.back();
+            free_ring_buffer_indices.pop_back();
+        }
+        this_threads_ring_buffer.ring_buffer = ring_buffers[this_threads_ring_buffer.thread_index].get();
+    }
+    return *this_threads_ring_buffer.ring_buffer;
+}
+
+void FrameProfiler::release_ring_buffer(std::uint32_t thread_index) {
+    std::lock_guard<std::mutex> lock(ring_buffers_mutex);
+    free_ring_buffer_indices.push_back(thread_index);
+}
+
+void FrameProfiler::record(const char *name, std::uint64_t start_ns, std::uint64_t end_ns) {
+    ProfileEventRingBuffer &ring_buffer = get_ring_buffer_for_this_thread();
+    ring_buffer.push({name, start_ns, end_ns, get_frame_index(), this_threads_ring_buffer.thread_index});
+}
+
+void FrameProfiler::collect() {
+    std::lock_guard<std::mutex> buffers_lock(ring_buffers_mutex);
+    std::lock_guard<std::mutex> events_lock(collected_events_mutex);
+
+    for (auto &ring_buffer : ring_buffers) {
+        ring_buffer->drain([&](const ProfileEvent &event) {
+            collected_events.push_back(event);
+            if (collected_events.size() > max_collected_events) {
+                collected_events.pop_front();
+            }
+        });
+    }
+}
+
+void FrameProfiler::clear_collected_events() {
+    std::lock_guard<std::mutex> lock(collected_events_mutex);
+    collected_events.clear();
+}
+
+std::uint64_t FrameProfiler::get_num_dropped_events() {
+    std::lock_guard<std::mutex> lock(ring_buffers_mutex);
+    std::uint64_t num_dropped = 0;
+    for (auto &ring_buffer : ring_buffers) {
+        num_dropped += ring_buffer->num_dropped_events.load(std::memory_order_relaxed);
+    }
+    return num_dropped;
+}
+
+bool FrameProfiler::export_chrome_trace(const std::string &file_path) {
+    collect();
+
+    std::ofstream out(file_path);
+    if (!out) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(collected_events_mutex);
+
+    std::uint64_t origin_ns = collected_events.empty() ? 0 : collected_events.front().start_ns;
+    for (const auto &event : collected_events) {
+        origin_ns = std::min(origin_ns, event.start_ns);
+    }
+
+    // NOTE: chrome trace timestamps and durations are in microseconds
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto &event : collected_events) {
+        if (!first) {
+            out << ",";
+        }
+        first = false;
+        out << "{\"name\":\"";
+        write_json_escaped(out, event.name);
+        out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread_index;
+        out << ",\"ts\":" << (event.start_ns - origin_ns) / 1000.0;
+        out << ",\"dur\":" << (event.end_ns - event.start_ns) / 1000.0;
+        out << ",\"args\":{\"frame\":" << event.frame_index << "}}";
+    }
+    out << "]}";
+
+    return static_cast<bool>(out);
+}
+
+std::vector<ScopeFrameTimeStats> FrameProfiler::get_scope_frame_time_stats() {
+    collect();
+
+    // NOTE: names are compared by content because the same literal can have different addresses across translation
+    // units
+    std::unordered_map<std::string, std::unordered_map<std::uint64_t, double>> scope_to_frame_to_total_ms;
+    {
+        std::lock_guard<std::mutex> lock(collected_events_mutex);
+        for (const auto &event : collected_events) {
+            scope_to_frame_to_total_ms[event.name][event.frame_index] += (event.end_ns - event.start_ns) / 1e6;
+        }
+    }
+
+    std::vector<ScopeFrameTimeStats> all_stats;
+    for (const auto &[name, frame_to_total_ms] : scope_to_frame_to_total_ms) {
+        std::vector<double> frame_totals_ms;
+        frame_totals_ms.reserve(frame_to_total_ms.size());
+        for (const auto &[frame, total_ms] : frame_to_total_ms) {
+            frame_totals_ms.push_back(total_ms);
+        }
+        std::sort(frame_totals_ms.begin(), frame_totals_ms.end());
+
+        all_stats.push_back({name, frame_totals_ms.size(), percentile_of_sorted(frame_totals_ms, 0.5),
+                             percentile_of_sorted(frame_totals_ms, 0.9), percentile_of_sorted(frame_totals_ms, 0.99),
+                             frame_totals_ms.back()});
+    }
+
+    std::sort(all_stats.begin(), all_stats.end(),
+              [](const ScopeFrameTimeStats &a, const ScopeFrameTimeStats &b) { return a.p99_ms > b.p99_ms; });
+    return all_stats;
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,167 @@
+#ifndef FRAME_PROFILER_HPP
+#define FRAME_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tbx_engine {
+
+/// nanoseconds on the steady clock, all profiler timestamps use this
+inline std::uint64_t profiler_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+struct ProfileEvent {
+    /// @note this must point to a string that outlives the profiler, eg a string literal
+    const char *name;
+    std::uint64_t start_ns;
+    std::uint64_t end_ns;
+    std::uint64_t frame_index;
+    std::uint32_t thread_index;
+};
+
+/**
+ * @brief a single producer single consumer ring buffer of profile events
+ *
+ * the owning thread pushes, the thread that collects the profile drains, neither of them ever takes a lock, when the
+ * buffer is full new events are dropped and counted instead of blocking the producer
+ */
+class ProfileEventRingBuffer {
+  public:
+    static constexpr std::size_t capacity = 1 << 14;
+
+    bool push(const ProfileEvent &event) {
+        std::size_t head = write_index.load(std::memory_order_relaxed);
+        std::size_t tail = read_index.load(std::memory_order_acquire);
+        if (head - tail == capacity) {
+            num_dropped_events.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        events[head % capacity] = event;
+        write_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename EventConsumer> std::size_t drain(EventConsumer &&consume) {
+        std::size_t tail = read_index.load(std::memory_order_relaxed);
+        std::size_t head = write_index.load(std::memory_order_acquire);
+        for (std::size_t i = tail; i != head; i++) {
+            consume(events[i % capacity]);
+        }
+        read_index.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    std::atomic<std::uint64_t> num_dropped_events{0};
+
+  private:
+    std::array<ProfileEvent, capacity> events;
+    alignas(64) std::atomic<std::size_t> write_index{0};
+    alignas(64) std::atomic<std::size_t> read_index{0};
+};
+
+struct ScopeFrameTimeStats {
+    std::string name;
+    /// the number of frames in which the scope ran at least once
+    std::size_t num_frames;
+    /// these are the per frame totals of the scope in milliseconds
+    double p50_ms, p90_ms, p99_ms, max_ms;
+};
+
+/**
+ * @brief records timed scopes from any thread into per thread lock free ring buffers
+ *
+ * when disabled recording a scope costs a relaxed atomic load and a branch, so the profiler can stay compiled into
+ * production builds, collect must be called regularly (the engine does it once per tick) so the ring buffers don't
+ * overflow, the collected events can then be written out as a chrome trace (open it in chrome://tracing or perfetto)
+ * or summarized as per scope frame time percentiles
+ *
+ */
+class FrameProfiler {
+  public:
+    /// the oldest collected events are discarded once there are more than this many
+    std::size_t max_collected_events = 1 << 20;
+
+    void enable() { enabled.store(true, std::memory_order_relaxed); }
+    void disable() { enabled.store(false, std::memory_order_relaxed); }
+    bool is_enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    void record(const char *name, std::uint64_t start_ns, std::uint64_t end_ns);
+
+    /// marks the start of a new frame, events recorded after this are attributed to it
+    void begin_frame() { frame_index.fetch_add(1, std::memory_order_relaxed); }
+    std::uint64_t get_frame_index() const { return frame_index.load(std::memory_order_relaxed); }
+
+    /// moves every event out of the per thread ring buffers into the collected events
+    void collect();
+    void clear_collected_events();
+    std::uint64_t get_num_dropped_events();
+
+    /// called when a thread which recorded events exits, its buffer is reused by the next new thread
+    void release_ring_buffer(std::uint32_t thread_index);
+
+    bool export_chrome_trace(const std::string &file_path);
+    std::vector<ScopeFrameTimeStats> get_scope_frame_time_stats();
+
+  private:
+    ProfileEventRingBuffer &get_ring_buffer_for_this_thread();
+
+    std::atomic<bool> enabled{false};
+    std::atomic<std::uint64_t> frame_index{0};
+
+    std::mutex ring_buffers_mutex;
+    std::vector<std::unique_ptr<ProfileEventRingBuffer>> ring_buffers;
+    std::vector<std::uint32_t> free_ring_buffer_indices;
+
+    std::mutex collected_events_mutex;
+    // NOTE: a deque so that once it is full the oldest event is dropped in constant time instead of shifting the rest
+    std::deque<ProfileEvent> collected_events;
+};
+
+FrameProfiler &get_frame_profiler();
+
+/// times the enclosing scope if the profiler is enabled when the scope is entered
+class ProfileScope {
+  public:
+    explicit ProfileScope(const char *name) : name(name) {
+        if (get_frame_profiler().is_enabled()) {
+            start_ns = profiler_now_ns();
+        }
+    }
+
+    ~ProfileScope() {
+        if (start_ns != 0) {
+            get_frame_profiler().record(name, start_ns, profiler_now_ns());
+        }
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+  private:
+    const char *name;
+    std::uint64_t start_ns = 0;
+};
+
+} // namespace tbx_engine
+
+#define TBX_PROFILE_CONCAT_INNER(a, b) a##b
+#define TBX_PROFILE_CONCAT(a, b) TBX_PROFILE_CONCAT_INNER(a, b)
+
+// NOTE: define TBX_ENGINE_DISABLE_PROFILING to compile every scope out entirely
+#ifdef TBX_ENGINE_DISABLE_PROFILING
+#define TBX_PROFILE_SCOPE(name)
+#else
+#define TBX_PROFILE_SCOPE(name) tbx_engine::ProfileScope TBX_PROFILE_CONCAT(tbx_profile_scope_, __LINE__)(name)
+#endif
+
+#endif // FRAME_PROFILER_HPP
@@ -0,0 +1,81 @@
+#include "frame_rate_governor.hpp"
+
+#include <algorithm>
+
+namespace tbx_engine {
+
+std::optional<double> FrameRateGovernor::update(Clock::time_point now, const WindowActivity &window_activity,
+                                                bool had_input, double frame_work_s) {
+    last_window_activity = window_activity;
+    if (had_input) {
+        last_input_time = now;
+    }
+
+    if (not enabled) {
+        throttled = false;
+        current_rate_hz = full_rate_hz;
+        return full_rate_hz;
+    }
+
+    update_load_cap(frame_work_s, current_rate_hz);
+
+    double seconds_since_input = std::chrono::duration<double>(now - last_input_time).count();
+    bool no_recent_input = seconds_since_input >= idle_after_s;
+
+    std::optional<double> cap_hz = load_cap_hz;
+    auto lower_cap_to = [&](double rate_hz) { cap_hz = std::min(cap_hz.value_or(rate_hz), rate_hz); };
+
+    if (window_activity.minimized) {
+        lower_cap_to(minimized_rate_hz);
+    } else if (not window_activity.focused and no_recent_input) {
+        lower_cap_to(unfocused_rate_hz);
+    }
+    if ((window_activity.menu_open or scene_is_static) and no_recent_input) {
+        lower_cap_to(idle_rate_hz);
+    }
+
+    std::optional<double> rate_hz = full_rate_hz;
+    if (cap_hz.has_value()) {
+        double capped_rate_hz = std::max(*cap_hz, min_rate_hz);
+        rate_hz = full_rate_hz.has_value() ? std::min(*full_rate_hz, capped_rate_hz) : capped_rate_hz;
+    }
+
+    throttled = rate_hz != full_rate_hz;
+    current_rate_hz = rate_hz;
+    return rate_hz;
+}
+
+void FrameRateGovernor::update_load_cap(double frame_work_s, std::optional<double> rate_hz) {
+    // NOTE: without a rate there is no budget to exceed
+    if (not rate_hz.has_value() or frame_work_s <= 0) {
+        return;
+    }
+    double budget_s = 1.0 / *rate_hz;
+
+    if (frame_work_s > budget_s) {
+        num_over_budget_frames++;
+        num_under_budget_frames = 0;
+    } else if (frame_work_s < 0.5 * budget_s) {
+        num_under_budget_frames++;
+        num_over_budget_frames = 0;
+    } else {
+        num_over_budget_frames = 0;
+        num_under_budget_frames = 0;
+    }
+
+    if (num_over_budget_frames >= over_budget_frames) {
+        // NOTE: a little headroom so a frame that just barely fits doesn't put us straight back over budget
+        load_cap_hz = std::max(min_rate_hz, 1.0 / (frame_work_s * 1.1));
+        num_over_budget_frames = 0;
+    }
+
+    if (load_cap_hz.has_value() and num_under_budget_frames >= recover_frames) {
+        load_cap_hz = *load_cap_hz * 1.25;
+        if (full_rate_hz.has_value() and *load_cap_hz >= *full_rate_hz) {
+            load_cap_hz = std::nullopt;
+        }
+        num_under_budget_frames = 0;
+    }
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,81 @@
+#ifndef FRAME_RATE_GOVERNOR_HPP
+#define FRAME_RATE_GOVERNOR_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace tbx_engine {
+
+/// what the governor needs to know about the window, a headless engine always reports the default
+struct WindowActivity {
+    bool minimized = false;
+    bool focused = true;
+    bool menu_open = false;
+    bool operator==(const WindowActivity &other) const = default;
+};
+
+/**
+ * @brief lowers the main loop's rate while nobody is looking or while the machine can't keep up, and gives the full
+ * rate back the moment there is input
+ *
+ * every tick the governor picks the lowest of these caps that apply and never goes below min_rate_hz:
+ * - minimized_rate_hz while the window is minimized
+ * - unfocused_rate_hz while the window is unfocused and there was no input for idle_after_s
+ * - idle_rate_hz while the menu is open or scene_is_static is set and there was no input for idle_after_s
+ * - a load cap when the work in a frame kept exceeding the frame budget for over_budget_frames frames in a row, it
+ *   is raised again step by step once frames fit comfortably for recover_frames frames
+ *
+ * the full rate is max_fps from the config
+ *
+ */
+class FrameRateGovernor {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    bool enabled = true;
+    /// set this when nothing on screen is moving, the governor then treats the scene like an open menu
+    bool scene_is_static = false;
+
+    double min_rate_hz = 5;
+    double minimized_rate_hz = 5;
+    double unfocused_rate_hz = 30;
+    double idle_rate_hz = 15;
+    double idle_after_s = 2;
+    std::uint32_t over_budget_frames = 30;
+    std::uint32_t recover_frames = 120;
+
+    /// std::nullopt means unlimited
+    void set_full_rate_hz(std::optional<double> rate_hz) { full_rate_hz = rate_hz; }
+    std::optional<double> get_full_rate_hz() const { return full_rate_hz; }
+
+    /**
+     * @brief decides the rate for the coming frames
+     * @param had_input whether any input arrived during the frame that just ran
+     * @param frame_work_s how long the frame that just ran took without counting time spent waiting
+     * @return the rate the loop should run at, std::nullopt meaning unlimited
+     */
+    std::optional<double> update(Clock::time_point now, const WindowActivity &window_activity, bool had_input,
+                                 double frame_work_s);
+
+    /// true while the loop runs below the full rate
+    bool is_throttled() const { return throttled; }
+    const WindowActivity &get_last_window_activity() const { return last_window_activity; }
+
+  private:
+    void update_load_cap(double frame_work_s, std::optional<double> rate_hz);
+
+    std::optional<double> full_rate_hz;
+    std::optional<double> load_cap_hz;
+    std::uint32_t num_over_budget_frames = 0;
+    std::uint32_t num_under_budget_frames = 0;
+    std::optional<double> current_rate_hz;
+
+    Clock::time_point last_input_time = Clock::now();
+    WindowActivity last_window_activity;
+    bool throttled = false;
+};
+
+} // namespace tbx_engine
+
+#endif // FRAME_RATE_GOVERNOR_HPP
@@ -0,0 +1,263 @@
+#include "frame_telemetry.hpp"
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tbx_engine {
+
+std::size_t DurationHistogram::get_bucket_index(std::uint64_t value_ns) {
+    if (value_ns < sub_bucket_count) {
+        return value_ns;
+    }
+    // NOTE: the shift is picked so that value_ns >> shift lands in the upper half of the sub buckets
+    int shift = std::bit_width(value_ns) - sub_bucket_bits;
+    std::uint64_t sub_bucket_index = (value_ns >> shift) - sub_bucket_half_count;
+    return sub_bucket_count + (shift - 1) * sub_bucket_half_count + sub_bucket_index;
+}
+
+std::uint64_t DurationHistogram::get_highest_value_in_bucket(std::size_t bucket_index) {
+    if (bucket_index < sub_bucket_count) {
+        return bucket_index;
+    }
+    std::size_t shift = (bucket_index - sub_bucket_count) / sub_bucket_half_count + 1;
+    std::uint64_t sub_bucket_index = (bucket_index - sub_bucket_count) % sub_bucket_half_count + sub_bucket_half_count;
+    return ((sub_bucket_index + 1) << shift) - 1;
+}
+
+void DurationHistogram::record(std::uint64_t value_ns) {
+    value_ns = std::min<std::uint64_t>(value_ns, (std::uint64_t(1) << max_value_bits) - 1);
+    counts[get_bucket_index(value_ns)]++;
+    count++;
+    max_value_ns = std::max(max_value_ns, value_ns);
+}
+
+void DurationHistogram::reset() {
+    counts.fill(0);
+    count = 0;
+    max_value_ns = 0;
+}
+
+std::uint64_t DurationHistogram::get_value_at_percentile(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    auto rank = static_cast<std::uint64_t>(percentile / 100.0 * count + 0.5);
+    rank = std::clamp<std::uint64_t>(rank, 1, count);
+
+    std::uint64_t num_seen = 0;
+    for (std::size_t i = 0; i < num_buckets; i++) {
+        num_seen += counts[i];
+        if (num_seen >= rank) {
+            return std::min(get_highest_value_in_bucket(i), max_value_ns);
+        }
+    }
+    return max_value_ns;
+}
+
+void FrameTelemetry::begin_frame(std::uint64_t frame_index) {
+    std::uint64_t now_ns = profiler_now_ns();
+    if (frame_started) {
+        finish_frame(now_ns);
+    }
+    frame_started = true;
+    current_frame_index = frame_index;
+    current_frame_start_ns = now_ns;
+    current_phase_ns.fill(0);
+
+    if (shared_memory.is_open() and now_ns - last_publish_ns >= publish_interval_ns) {
+        shared_memory.publish(get_snapshot());
+        last_publish_ns = now_ns;
+    }
+}
+
+void FrameTelemetry::finish_frame(std::uint64_t frame_end_ns) {
+    std::uint64_t frame_ns = frame_end_ns - current_frame_start_ns;
+    current_phase_ns[static_cast<std::size_t>(FramePhase::frame)] = frame_ns;
+
+    std::uint64_t accounted_ns = 0;
+    for (std::size_t i = 0; i < num_frame_phases; i++) {
+        auto phase = static_cast<FramePhase>(i);
+        if (phase != FramePhase::frame and phase != FramePhase::wait) {
+            accounted_ns += current_phase_ns[i];
+        }
+    }
+    std::uint64_t wait_ns = frame_ns > accounted_ns ? frame_ns - accounted_ns : 0;
+    current_phase_ns[static_cast<std::size_t>(FramePhase::wait)] = wait_ns;
+
+    for (std::size_t i = 0; i < num_frame_phases; i++) {
+        histograms[i].record(current_phase_ns[i]);
+    }
+    last_frame_phase_ns = current_phase_ns;
+
+    // NOTE: worst_frames is kept sorted from worst to least bad, so a frame only gets in if it beats the last one
+    double frame_ms = frame_ns / 1e6;
+    bool is_full = num_worst_frames == worst_frames.size();
+    if (is_full and frame_ms <= worst_frames.back().phase_ms[static_cast<std::size_t>(FramePhase::frame)]) {
+        return;
+    }
+    WorstFrame worst_frame;
+    worst_frame.frame_index = current_frame_index;
+    for (std::size_t i = 0; i < num_frame_phases; i++) {
+        worst_frame.phase_ms[i] = current_phase_ns[i] / 1e6;
+    }
+    std::size_t insert_index = is_full ? worst_frames.size() - 1 : num_worst_frames++;
+    while (insert_index > 0 and
+           worst_frames[insert_index - 1].phase_ms[static_cast<std::size_t>(FramePhase::frame)] < frame_ms) {
+        worst_frames[insert_index] = worst_frames[insert_index - 1];
+        insert_index--;
+    }
+    worst_frames[insert_index] = worst_frame;
+}
+
+FrameTelemetrySnapshot FrameTelemetry::get_snapshot() const {
+    FrameTelemetrySnapshot snapshot;
+    snapshot.num_frames = histograms[static_cast<std::size_t>(FramePhase::frame)].get_count();
+    for (std::size_t i = 0; i < num_frame_phases; i++) {
+        const DurationHistogram &histogram = histograms[i];
+        FramePhaseStats &stats = snapshot.phase_stats[i];
+        stats.count = histogram.get_count();
+        stats.p50_ms = histogram.get_value_at_percentile(50) / 1e6;
+        stats.p99_ms = histogram.get_value_at_percentile(99) / 1e6;
+        stats.p999_ms = histogram.get_value_at_percentile(99.9) / 1e6;
+        stats.max_ms = histogram.get_max() / 1e6;
+    }
+    snapshot.worst_frames = worst_frames;
+    snapshot.num_worst_frames = num_worst_frames;
+    return snapshot;
+}
+
+void FrameTelemetry::reset() {
+    for (DurationHistogram &histogram : histograms) {
+        histogram.reset();
+    }
+    num_worst_frames = 0;
+    frame_started = false;
+}
+
+bool FrameTelemetry::start_shared_memory_export(const std::string &name) {
+    last_publish_ns = 0;
+    return shared_memory.open_for_writing(name);
+}
+
+FramePhaseTimer::FramePhaseTimer(FrameTelemetry &frame_telemetry, FramePhase phase)
+    : frame_telemetry(frame_telemetry), phase(phase), start_ns(profiler_now_ns()) {}
+
+FramePhaseTimer::~FramePhaseTimer() { frame_telemetry.add_phase_time(phase, profiler_now_ns() - start_ns); }
+
+bool FrameTelemetrySharedMemory::open_for_writing(const std::string &name) { return open(name, true); }
+
+bool FrameTelemetrySharedMemory::open_for_reading(const std::string &name) { return open(name, false); }
+
+bool FrameTelemetrySharedMemory::open(const std::string &name, bool for_writing) {
+    close();
+    constexpr std::size_t block_size = sizeof(FrameTelemetrySharedBlock);
+    void *view = nullptr;
+
+#ifdef _WIN32
+    // NOTE: windows object names can't contain a backslash and don't need posix's leading slash
+    std::string mapping_name = "Local\\" + (name.size() > 0 and name[0] == '/' ? name.substr(1) : name);
+    HANDLE mapping = for_writing ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                                      static_cast<DWORD>(block_size), mapping_name.c_str())
+                                 : OpenFileMappingA(FILE_MAP_READ, FALSE, mapping_name.c_str());
+    if (mapping == nullptr) {
+        return false;
+    }
+    view = MapViewOfFile(mapping, for_writing ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, block_size);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_handle = mapping;
+#else
+    int fd = for_writing ? shm_open(name.c_str(), O_CREAT | O_RDWR, 0644) : shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat segment_stat;
+    bool size_ok = for_writing ? ftruncate(fd, block_size) == 0
+                               : fstat(fd, &segment_stat) == 0 and
+                                     static_cast<std::size_t>(segment_stat.st_size) >= block_size;
+    if (size_ok) {
+        view = mmap(nullptr, block_size, for_writing ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (not size_ok or view == MAP_FAILED) {
+        return false;
+    }
+#endif
+
+    block = static_cast<FrameTelemetrySharedBlock *>(view);
+    owns_segment = for_writing;
+    segment_name = name;
+    if (for_writing) {
+        block->sequence.store(0, std::memory_order_relaxed);
+        block->snapshot = FrameTelemetrySnapshot();
+        block->version = FrameTelemetrySharedBlock::expected_version;
+        // NOTE: the magic is written last so a reader never accepts a half initialized block
+        std::atomic_thread_fence(std::memory_order_release);
+        block->magic = FrameTelemetrySharedBlock::expected_magic;
+    }
+    return true;
+}
+
+void FrameTelemetrySharedMemory::close() {
+    if (block == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(block);
+    CloseHandle(mapping_handle);
+    mapping_handle = nullptr;
+#else
+    munmap(block, sizeof(FrameTelemetrySharedBlock));
+    if (owns_segment) {
+        shm_unlink(segment_name.c_str());
+    }
+#endif
+    block = nullptr;
+}
+
+void FrameTelemetrySharedMemory::publish(const FrameTelemetrySnapshot &snapshot) {
+    if (block == nullptr or not owns_segment) {
+        return;
+    }
+    std::uint64_t sequence = block->sequence.load(std::memory_order_relaxed);
+    block->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(static_cast<void *>(&block->snapshot), &snapshot, sizeof(snapshot));
+    block->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool FrameTelemetrySharedMemory::try_read(FrameTelemetrySnapshot &snapshot, int max_attempts) const {
+    if (block == nullptr or block->magic != FrameTelemetrySharedBlock::expected_magic or
+        block->version != FrameTelemetrySharedBlock::expected_version) {
+        return false;
+    }
+    for (int attempt = 0; attempt < max_attempts; attempt++) {
+        std::uint64_t sequence_before = block->sequence.load(std::memory_order_acquire);
+        if (sequence_before % 2 == 1) {
+            continue;
+        }
+        std::memcpy(static_cast<void *>(&snapshot), &block->snapshot, sizeof(snapshot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (block->sequence.load(std::memory_order_relaxed) == sequence_before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,201 @@
+#ifndef FRAME_TELEMETRY_HPP
+#define FRAME_TELEMETRY_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace tbx_engine {
+
+/**
+ * @brief a histogram of durations in nanoseconds whose buckets grow with the value, so every recorded value is kept to
+ * within about 1.5% no matter if it's a microsecond or a minute, in the style of hdr histogram
+ *
+ * values below 128ns get a bucket each, after that every power of two range is split into 64 equal buckets, recording
+ * is a couple of shifts and an increment and the whole histogram is a fixed 16kb
+ *
+ */
+class DurationHistogram {
+  public:
+    static constexpr int sub_bucket_bits = 7;
+    static constexpr std::uint64_t sub_bucket_count = 1 << sub_bucket_bits;
+    static constexpr std::uint64_t sub_bucket_half_count = sub_bucket_count / 2;
+    /// anything longer than about 68 seconds is recorded as the largest trackable value
+    static constexpr int max_value_bits = 36;
+    static constexpr std::size_t num_buckets =
+        sub_bucket_count + (max_value_bits - sub_bucket_bits) * sub_bucket_half_count;
+
+    void record(std::uint64_t value_ns);
+    void reset();
+
+    std::uint64_t get_count() const { return count; }
+    std::uint64_t get_max() const { return max_value_ns; }
+    /// @param percentile between 0 and 100
+    /// @return the largest value that falls into the same bucket as the value at that percentile
+    std::uint64_t get_value_at_percentile(double percentile) const;
+
+  private:
+    static std::size_t get_bucket_index(std::uint64_t value_ns);
+    static std::uint64_t get_highest_value_in_bucket(std::size_t bucket_index);
+
+    std::array<std::uint64_t, num_buckets> counts{};
+    std::uint64_t count = 0;
+    std::uint64_t max_value_ns = 0;
+};
+
+/// the parts of a frame that are timed, wait is whatever is left of the frame after the others, which is the time spent
+/// rate limiting plus anything not covered by the others, present is the end of tick window logic which swaps the
+/// buffers, with vsync on that blocks until the display takes the frame so it is kept apart from the rest of window
+enum class FramePhase : std::uint8_t { frame, update, window, present, jobs, input, wait, count };
+
+constexpr std::size_t num_frame_phases = static_cast<std::size_t>(FramePhase::count);
+
+const std::array<const char *, num_frame_phases> frame_phase_names = {"frame", "update", "window", "present",
+                                                                       "jobs",  "input",  "wait"};
+
+struct FramePhaseStats {
+    std::uint64_t count = 0;
+    double p50_ms = 0, p99_ms = 0, p999_ms = 0, max_ms = 0;
+};
+
+struct WorstFrame {
+    std::uint64_t frame_index = 0;
+    /// indexed by FramePhase
+    std::array<double, num_frame_phases> phase_ms{};
+};
+
+/// @note this is trivially copyable and has a fixed size because it is what gets written into shared memory
+struct FrameTelemetrySnapshot {
+    static constexpr std::size_t max_worst_frames = 8;
+
+    std::uint64_t num_frames = 0;
+    /// indexed by FramePhase
+    std::array<FramePhaseStats, num_frame_phases> phase_stats{};
+    /// sorted from worst to least bad
+    std::array<WorstFrame, max_worst_frames> worst_frames{};
+    std::uint32_t num_worst_frames = 0;
+};
+
+/**
+ * @brief the layout of the shared memory segment, a seqlock around a snapshot
+ *
+ * the writer makes sequence odd, writes the snapshot and makes it even again, a reader copies the snapshot and only
+ * keeps the copy if sequence was the same even number before and after, so the writer never waits for a reader
+ */
+struct FrameTelemetrySharedBlock {
+    static constexpr std::uint64_t expected_magic = 0x5442584654454c45; // "TBXFTELE"
+    static constexpr std::uint32_t expected_version = 1;
+
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::atomic<std::uint64_t> sequence;
+    FrameTelemetrySnapshot snapshot;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the seqlock must be usable across processes");
+
+/**
+ * @brief a named shared memory segment holding a FrameTelemetrySharedBlock, the engine opens it for writing and a
+ * dashboard process opens it for reading
+ *
+ * on posix this is shm_open, the segment shows up as /dev/shm/<name> on linux, on windows a named file mapping
+ */
+class FrameTelemetrySharedMemory {
+  public:
+    FrameTelemetrySharedMemory() = default;
+    ~FrameTelemetrySharedMemory() { close(); }
+    FrameTelemetrySharedMemory(const FrameTelemetrySharedMemory &) = delete;
+    FrameTelemetrySharedMemory &operator=(const FrameTelemetrySharedMemory &) = delete;
+
+    /// creates the segment if needed, the name should start with a slash, eg "/tbx_engine_telemetry"
+    bool open_for_writing(const std::string &name);
+    bool open_for_reading(const std::string &name);
+    void close();
+    bool is_open() const { return block != nullptr; }
+
+    void publish(const FrameTelemetrySnapshot &snapshot);
+
+    /// @return false if the segment isn't valid or the writer kept getting in the way
+    bool try_read(FrameTelemetrySnapshot &snapshot, int max_attempts = 64) const;
+
+  private:
+    bool open(const std::string &name, bool for_writing);
+
+    FrameTelemetrySharedBlock *block = nullptr;
+    bool owns_segment = false;
+    std::string segment_name;
+#ifdef _WIN32
+    void *mapping_handle = nullptr;
+#endif
+};
+
+/**
+ * @brief collects the duration of every frame and of its phases into histograms
+ *
+ * recording a frame is a handful of histogram increments, the percentiles are only computed when a snapshot is taken,
+ * which the shared memory export does a few times a second
+ *
+ */
+class FrameTelemetry {
+  public:
+    /// call at the very start of every tick, this finishes the previous frame whose duration is start to start
+    void begin_frame(std::uint64_t frame_index);
+
+    /// adds to the time spent in phase during the current frame
+    void add_phase_time(FramePhase phase, std::uint64_t duration_ns) {
+        current_phase_ns[static_cast<std::size_t>(phase)] += duration_ns;
+    }
+
+    FrameTelemetrySnapshot get_snapshot() const;
+    void reset();
+
+    /// how long phase took in the last finished frame
+    std::uint64_t get_last_frame_ns(FramePhase phase) const {
+        return last_frame_phase_ns[static_cast<std::size_t>(phase)];
+    }
+
+    const DurationHistogram &get_histogram(FramePhase phase) const {
+        return histograms[static_cast<std::size_t>(phase)];
+    }
+
+    /// starts publishing a snapshot into a shared memory segment with this name every publish_interval_ns
+    bool start_shared_memory_export(const std::string &name = "/tbx_engine_telemetry");
+    void stop_shared_memory_export() { shared_memory.close(); }
+
+    std::uint64_t publish_interval_ns = 250'000'000;
+
+  private:
+    void finish_frame(std::uint64_t frame_end_ns);
+
+    std::array<DurationHistogram, num_frame_phases> histograms;
+    std::array<std::uint64_t, num_frame_phases> current_phase_ns{};
+    std::array<std::uint64_t, num_frame_phases> last_frame_phase_ns{};
+    bool frame_started = false;
+    std::uint64_t current_frame_index = 0;
+    std::uint64_t current_frame_start_ns = 0;
+
+    std::array<WorstFrame, FrameTelemetrySnapshot::max_worst_frames> worst_frames{};
+    std::uint32_t num_worst_frames = 0;
+
+    FrameTelemetrySharedMemory shared_memory;
+    std::uint64_t last_publish_ns = 0;
+};
+
+/// adds the time from its construction to its destruction to a phase of the current frame
+class FramePhaseTimer {
+  public:
+    FramePhaseTimer(FrameTelemetry &frame_telemetry, FramePhase phase);
+    ~FramePhaseTimer();
+    FramePhaseTimer(const FramePhaseTimer &) = delete;
+    FramePhaseTimer &operator=(const FramePhaseTimer &) = delete;
+
+  private:
+    FrameTelemetry &frame_telemetry;
+    FramePhase phase;
+    std::uint64_t start_ns;
+};
+
+} // namespace tbx_engine
+
+#endif // FRAME_TELEMETRY_HPP
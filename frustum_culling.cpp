@@ -0,0 +1,187 @@
+#include "frustum_culling.hpp"
+
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE__) or defined(_M_X64) or (defined(_M_IX86_FP) and _M_IX86_FP >= 1)
+#define TBX_ENGINE_FRUSTUM_CULLING_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace tbx_engine {
+
+Frustum Frustum::from_projection_view(const glm::mat4 &projection_view) {
+    // NOTE: glm is column major so m[column][row], row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const glm::mat4 &m = projection_view;
+    auto row = [&](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+    Frustum frustum;
+    frustum.planes[left_plane] = row(3) + row(0);
+    frustum.planes[right_plane] = row(3) - row(0);
+    frustum.planes[bottom_plane] = row(3) + row(1);
+    frustum.planes[top_plane] = row(3) - row(1);
+    frustum.planes[near_plane] = row(3) + row(2);
+    frustum.planes[far_plane] = row(3) - row(2);
+
+    for (glm::vec4 &plane : frustum.planes) {
+        float normal_length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (normal_length > 0) {
+            plane = glm::vec4(plane[0] / normal_length, plane[1] / normal_length, plane[2] / normal_length,
+                              plane[3] / normal_length);
+        }
+    }
+    return frustum;
+}
+
+CullObjectId FrustumCuller::add_object(const glm::vec3 &min_corner, const glm::vec3 &max_corner) {
+    CullObjectId id;
+    if (not free_ids.empty()) {
+        id = free_ids.back();
+        free_ids.pop_back();
+    } else {
+        id = num_slots++;
+        if (num_slots > min_x.size()) {
+            std::size_t padded_size = min_x.size() + 4;
+            for (std::vector<float> *component : {&min_x, &min_y, &min_z, &max_x, &max_y, &max_z}) {
+                component->resize(padded_size, 0);
+            }
+            alive.resize(padded_size, 0);
+        }
+    }
+    alive[id] = 1;
+    num_objects++;
+    set_bounds(id, min_corner, max_corner);
+    return id;
+}
+
+void FrustumCuller::set_bounds(CullObjectId id, const glm::vec3 &min_corner, const glm::vec3 &max_corner) {
+    // NOTE: a stale id would otherwise write past the bounds or bring a removed object's slot back
+    if (id >= num_slots or not alive[id]) {
+        return;
+    }
+    min_x[id] = min_corner.x;
+    min_y[id] = min_corner.y;
+    min_z[id] = min_corner.z;
+    max_x[id] = max_corner.x;
+    max_y[id] = max_corner.y;
+    max_z[id] = max_corner.z;
+}
+
+void FrustumCuller::remove_object(CullObjectId id) {
+    if (id >= num_slots or not alive[id]) {
+        return;
+    }
+    alive[id] = 0;
+    if (id < visible.size()) {
+        visible[id] = 0;
+    }
+    free_ids.push_back(id);
+    num_objects--;
+}
+
+void FrustumCuller::clear() {
+    for (std::vector<float> *component : {&min_x, &min_y, &min_z, &max_x, &max_y, &max_z}) {
+        component->clear();
+    }
+    alive.clear();
+    free_ids.clear();
+    num_slots = 0;
+    num_objects = 0;
+    visible.clear();
+    visible_objects.clear();
+}
+
+void FrustumCuller::cull(const Frustum &frustum) {
+    auto start = std::chrono::steady_clock::now();
+
+    visible.assign(min_x.size(), 0);
+    visible_objects.clear();
+
+#ifdef TBX_ENGINE_FRUSTUM_CULLING_SSE
+    if (use_simd) {
+        cull_simd(frustum, min_x.size());
+    } else {
+        cull_scalar(frustum, 0, min_x.size());
+    }
+#else
+    cull_scalar(frustum, 0, min_x.size());
+#endif
+
+    last_cull_stats.num_objects = num_objects;
+    last_cull_stats.num_visible = visible_objects.size();
+    last_cull_stats.num_culled = num_objects - visible_objects.size();
+    last_cull_stats.cull_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FrustumCuller::cull_scalar(const Frustum &frustum, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; i++) {
+        if (not alive[i]) {
+            continue;
+        }
+        bool inside = true;
+        for (const glm::vec4 &plane : frustum.planes) {
+            // NOTE: the corner furthest along the normal, if even that is behind the plane the whole box is
+            float x = plane[0] >= 0 ? max_x[i] : min_x[i];
+            float y = plane[1] >= 0 ? max_y[i] : min_y[i];
+            float z = plane[2] >= 0 ? max_z[i] : min_z[i];
+            // NOTE: written as not >= so that nan bounds are culled the same way the simd path culls them
+            if (not(plane[0] * x + plane[1] * y + plane[2] * z + plane[3] >= 0)) {
+                inside = false;
+                break;
+            }
+        }
+        if (inside) {
+            visible[i] = 1;
+            visible_objects.push_back(i);
+        }
+    }
+}
+
+#ifdef TBX_ENGINE_FRUSTUM_CULLING_SSE
+void FrustumCuller::cull_simd(const Frustum &frustum, std::size_t end) {
+    // NOTE: the corner to test only depends on the signs of the plane's normal, so it's picked once per plane by
+    // choosing which arrays to load from
+    struct PlaneLanes {
+        __m128 a, b, c, d;
+        const float *x, *y, *z;
+    };
+    std::array<PlaneLanes, Frustum::num_planes> plane_lanes;
+    for (std::size_t p = 0; p < Frustum::num_planes; p++) {
+        const glm::vec4 &plane = frustum.planes[p];
+        plane_lanes[p] = {_mm_set1_ps(plane[0]),
+                          _mm_set1_ps(plane[1]),
+                          _mm_set1_ps(plane[2]),
+                          _mm_set1_ps(plane[3]),
+                          plane[0] >= 0 ? max_x.data() : min_x.data(),
+                          plane[1] >= 0 ? max_y.data() : min_y.data(),
+                          plane[2] >= 0 ? max_z.data() : min_z.data()};
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    for (std::size_t i = 0; i < end; i += 4) {
+        int inside_mask = alive[i] | alive[i + 1] << 1 | alive[i + 2] << 2 | alive[i + 3] << 3;
+        for (const PlaneLanes &lanes : plane_lanes) {
+            if (inside_mask == 0) {
+                break;
+            }
+            // NOTE: summed in the same order as the scalar path so both give bit identical results
+            __m128 distance = _mm_mul_ps(lanes.a, _mm_loadu_ps(lanes.x + i));
+            distance = _mm_add_ps(distance, _mm_mul_ps(lanes.b, _mm_loadu_ps(lanes.y + i)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(lanes.c, _mm_loadu_ps(lanes.z + i)));
+            distance = _mm_add_ps(distance, lanes.d);
+            inside_mask &= _mm_movemask_ps(_mm_cmpge_ps(distance, zero));
+        }
+        for (std::size_t lane = 0; lane < 4; lane++) {
+            if (inside_mask & (1 << lane)) {
+                visible[i + lane] = 1;
+                visible_objects.push_back(i + lane);
+            }
+        }
+    }
+}
+#else
+void FrustumCuller::cull_simd(const Frustum &frustum, std::size_t end) { cull_scalar(frustum, 0, end); }
+#endif
+
+} // namespace tbx_engine
@@ -0,0 +1,96 @@
+#ifndef FRUSTUM_CULLING_HPP
+#define FRUSTUM_CULLING_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace tbx_engine {
+
+/**
+ * @brief the six planes of a view frustum in world space, each stored as (a, b, c, d) with a unit normal (a, b, c)
+ * pointing into the frustum, so a point p is inside a plane when dot(normal, p) + d >= 0
+ */
+struct Frustum {
+    // NOTE: not plain near and far since windows.h defines those as macros
+    enum Plane { left_plane, right_plane, bottom_plane, top_plane, near_plane, far_plane, num_planes };
+    std::array<glm::vec4, num_planes> planes;
+
+    /**
+     * @brief extracts the planes from a projection * view matrix with the gribb hartmann method
+     * @note assumes opengl clip space, where z goes from -w to w
+     */
+    static Frustum from_projection_view(const glm::mat4 &projection_view);
+};
+
+struct CullStats {
+    std::uint32_t num_objects = 0;
+    std::uint32_t num_visible = 0;
+    std::uint32_t num_culled = 0;
+    std::uint64_t cull_ns = 0;
+};
+
+using CullObjectId = std::uint32_t;
+
+/**
+ * @brief keeps the world space bounding boxes of objects and finds the ones that intersect a frustum
+ *
+ * the bounds are stored as one array per component so four boxes are tested against a plane at once with sse, there is
+ * a scalar fallback which gives the same results, for each plane only the corner of a box furthest along the plane's
+ * normal is tested, so a box is culled only when it is entirely outside at least one plane, a box that straddles the
+ * frustum's corner but misses it can still be reported as visible which is fine for culling
+ *
+ * it only needs the cpu, so it can be used and tested without a window or gl context
+ *
+ */
+class FrustumCuller {
+  public:
+    /// @return an id that stays valid until the object is removed, removed ids are reused
+    CullObjectId add_object(const glm::vec3 &min_corner, const glm::vec3 &max_corner);
+    CullObjectId add_object(const vertex_geometry::AxisAlignedBoundingBox &aabb) {
+        return add_object(aabb.min, aabb.max);
+    }
+    /// does nothing for an id that was removed or never added
+    void set_bounds(CullObjectId id, const glm::vec3 &min_corner, const glm::vec3 &max_corner);
+    void set_bounds(CullObjectId id, const vertex_geometry::AxisAlignedBoundingBox &aabb) {
+        set_bounds(id, aabb.min, aabb.max);
+    }
+    void remove_object(CullObjectId id);
+    void clear();
+
+    /// tests every object against the frustum, the results stay until the next call
+    void cull(const Frustum &frustum);
+
+    /// @note objects added after the last cull are not visible until the next one
+    bool is_visible(CullObjectId id) const { return id < visible.size() and visible[id]; }
+    /// the ids of the objects that passed the last cull in increasing order
+    const std::vector<CullObjectId> &get_visible_objects() const { return visible_objects; }
+    const CullStats &get_last_cull_stats() const { return last_cull_stats; }
+    std::size_t get_num_objects() const { return num_objects; }
+
+    /// the sse path is used when the compiler targets it, turn this off to compare against the scalar path
+    bool use_simd = true;
+
+  private:
+    void cull_scalar(const Frustum &frustum, std::size_t begin, std::size_t end);
+    void cull_simd(const Frustum &frustum, std::size_t end);
+
+    // NOTE: every array has the same length, which is kept a multiple of 4 so the simd loop never needs a tail
+    std::vector<float> min_x, min_y, min_z, max_x, max_y, max_z;
+    /// 1 for slots that hold an object, removed and padding slots are 0 so they're never visible
+    std::vector<std::uint8_t> alive;
+    std::vector<CullObjectId> free_ids;
+    /// slots that have ever held an object, the arrays are this long rounded up to a multiple of 4
+    std::size_t num_slots = 0;
+    std::size_t num_objects = 0;
+
+    std::vector<std::uint8_t> visible;
+    std::vector<CullObjectId> visible_objects;
+    CullStats last_cull_stats;
+};
+
+} // namespace tbx_engine
+
+#endif // FRUSTUM_CULLING_HPP
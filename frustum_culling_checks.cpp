@@ -0,0 +1,71 @@
+#include "engine_checks.hpp"
+#include "frustum_culling.hpp"
+
+#include <random>
+
+namespace tbx_engine {
+
+std::vector<CheckResult> run_frustum_culling_checks() {
+    std::vector<CheckResult> results;
+
+    // NOTE: a camera at the origin looking down -z
+    Frustum frustum = Frustum::from_projection_view(glm::perspective(1.2f, 16.0f / 9, 0.1f, 100.0f));
+
+    FrustumCuller culler;
+    CullObjectId in_front = culler.add_object({-1, -1, -6}, {1, 1, -4});
+    CullObjectId behind = culler.add_object({-1, -1, 4}, {1, 1, 6});
+    CullObjectId past_far_plane = culler.add_object({-1, -1, -206}, {1, 1, -204});
+    CullObjectId off_to_the_side = culler.add_object({100, -1, -6}, {102, 1, -4});
+    CullObjectId around_the_camera = culler.add_object({-1, -1, -1}, {1, 1, 1});
+    culler.cull(frustum);
+    results.push_back({"boxes in front of or around the camera are visible",
+                       culler.is_visible(in_front) and culler.is_visible(around_the_camera), ""});
+    results.push_back({"boxes behind, past the far plane or to the side are culled",
+                       not culler.is_visible(behind) and not culler.is_visible(past_far_plane) and
+                           not culler.is_visible(off_to_the_side),
+                       ""});
+
+    culler.set_bounds(behind, {-1, -1, -6}, {1, 1, -4});
+    culler.remove_object(in_front);
+    // NOTE: neither of these may touch the removed slot or write out of bounds
+    culler.set_bounds(in_front, {-1, -1, -6}, {1, 1, -4});
+    culler.set_bounds(1000, {-1, -1, -6}, {1, 1, -4});
+    culler.cull(frustum);
+    const CullStats &stats = culler.get_last_cull_stats();
+    results.push_back({"moved and removed objects are handled on the next cull",
+                       culler.is_visible(behind) and not culler.is_visible(in_front) and stats.num_objects == 4 and
+                           stats.num_visible == 2,
+                       std::to_string(stats.num_visible) + " of " + std::to_string(stats.num_objects) + " visible"});
+
+    // NOTE: an object count that isn't a multiple of 4 and some removed ids so the padding and dead slots are covered
+    FrustumCuller many_objects;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-150, 150);
+    for (int i = 0; i < 100'003; i++) {
+        glm::vec3 min_corner(position(rng), position(rng), position(rng));
+        many_objects.add_object(min_corner, min_corner + glm::vec3(2));
+    }
+    for (CullObjectId id = 0; id < 1000; id += 7) {
+        many_objects.remove_object(id);
+    }
+
+    many_objects.use_simd = true;
+    many_objects.cull(frustum);
+    std::vector<CullObjectId> simd_visible = many_objects.get_visible_objects();
+    std::uint64_t simd_ns = many_objects.get_last_cull_stats().cull_ns;
+
+    many_objects.use_simd = false;
+    many_objects.cull(frustum);
+    const std::vector<CullObjectId> &scalar_visible = many_objects.get_visible_objects();
+    std::uint64_t scalar_ns = many_objects.get_last_cull_stats().cull_ns;
+
+    results.push_back({"the sse and scalar paths find the same objects", simd_visible == scalar_visible,
+                       std::to_string(scalar_visible.size()) + " of " +
+                           std::to_string(many_objects.get_num_objects()) + " visible, sse " +
+                           std::to_string(simd_ns / 1000) + " us, scalar " + std::to_string(scalar_ns / 1000) +
+                           " us"});
+
+    return results;
+}
+
+} // namespace tbx_engine
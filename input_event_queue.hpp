@@ -0,0 +1,122 @@
+#ifndef INPUT_EVENT_QUEUE_HPP
+#define INPUT_EVENT_QUEUE_HPP
+
+#include "input_recording.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace tbx_engine {
+
+/// a single glfw input event as it arrived, the fields are used the same way as in RecordedInputEvent
+struct InputEvent {
+    /// steady clock time in nanoseconds of when the glfw callback ran
+    std::int64_t time_ns;
+    RecordedInputEventType type;
+    std::int32_t key, scancode, action, mods;
+    double x, y;
+
+    std::chrono::steady_clock::time_point get_arrival_time() const {
+        return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(time_ns));
+    }
+};
+
+/**
+ * @brief a lock free single producer single consumer queue of input events, the glfw callbacks push into it and the
+ * main loop drains it once per tick
+ *
+ * pushing is a copy and an atomic store so a high polling rate mouse costs almost nothing per event, when the queue is
+ * full new events are dropped and counted rather than blocking the callback
+ *
+ */
+class InputEventQueue {
+  public:
+    static constexpr std::size_t capacity = 1 << 12;
+
+    static std::int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    bool push(const InputEvent &event) {
+        std::size_t head = write_index.load(std::memory_order_relaxed);
+        std::size_t tail = read_index.load(std::memory_order_acquire);
+        if (head - tail == capacity) {
+            num_dropped_events.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        events[head % capacity] = event;
+        write_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void push_key(int key, int scancode, int action, int mods) {
+        push({now_ns(), RecordedInputEventType::key, key, scancode, action, mods, 0, 0});
+    }
+    void push_mouse_button(int button, int action, int mods) {
+        push({now_ns(), RecordedInputEventType::mouse_button, button, 0, action, mods, 0, 0});
+    }
+    void push_cursor_pos(double x, double y) {
+        push({now_ns(), RecordedInputEventType::cursor_pos, 0, 0, 0, 0, x, y});
+    }
+
+    /**
+     * @brief passes every queued event to consume in the order they arrived, except that each run of consecutive
+     * cursor events is passed as only its last event
+     *
+     * cursor positions are absolute so the last one of a run carries the whole motion of the run, and since a run ends
+     * at the next key or button event the order of those edges relative to the motion is kept exactly
+     *
+     * @return the number of events that were coalesced away
+     */
+    template <typename EventConsumer> std::size_t drain_coalesced(EventConsumer &&consume) {
+        std::size_t tail = read_index.load(std::memory_order_relaxed);
+        std::size_t head = write_index.load(std::memory_order_acquire);
+
+        std::size_t num_coalesced = 0;
+        const InputEvent *pending_cursor_event = nullptr;
+        for (std::size_t i = tail; i != head; i++) {
+            const InputEvent &event = events[i % capacity];
+            if (event.type == RecordedInputEventType::cursor_pos) {
+                if (pending_cursor_event != nullptr) {
+                    num_coalesced++;
+                }
+                pending_cursor_event = &event;
+                continue;
+            }
+            if (pending_cursor_event != nullptr) {
+                consume(*pending_cursor_event);
+                pending_cursor_event = nullptr;
+            }
+            consume(event);
+        }
+        if (pending_cursor_event != nullptr) {
+            consume(*pending_cursor_event);
+        }
+
+        // NOTE: the slots are only handed back to the producer once we're done reading them
+        read_index.store(head, std::memory_order_release);
+        num_coalesced_events += num_coalesced;
+        return num_coalesced;
+    }
+
+    /// @note only meaningful on the consumer's thread
+    bool is_empty() const {
+        return write_index.load(std::memory_order_acquire) == read_index.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<std::uint64_t> num_dropped_events{0};
+    std::uint64_t num_coalesced_events = 0;
+
+  private:
+    std::array<InputEvent, capacity> events;
+    alignas(64) std::atomic<std::size_t> write_index{0};
+    alignas(64) std::atomic<std::size_t> read_index{0};
+};
+
+} // namespace tbx_engine
+
+#endif // INPUT_EVENT_QUEUE_HPP
@@ -0,0 +1,260 @@
+#include "input_recording.hpp"
+
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tbx_engine {
+
+namespace {
+
+const char recording_magic[8] = {'T', 'B', 'X', 'I', 'N', 'P', 'U', 'T'};
+const std::uint32_t recording_version = 1;
+
+void write_u64(std::uint8_t *bytes, std::uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+std::uint64_t read_u64(const std::uint8_t *bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+void write_u32(std::uint8_t *bytes, std::uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+std::uint32_t read_u32(const std::uint8_t *bytes) {
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<std::uint32_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+void write_f64(std::uint8_t *bytes, double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    write_u64(bytes, bits);
+}
+
+double read_f64(const std::uint8_t *bytes) {
+    std::uint64_t bits = read_u64(bytes);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+bool InputRecorder::start_recording(const std::string &file_path, double fixed_dt) {
+    stop_recording();
+
+    out.open(file_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    std::uint8_t header[InputReplay::header_size] = {};
+    std::memcpy(header, recording_magic, sizeof(recording_magic));
+    write_u32(header + 8, recording_version);
+    write_f64(header + 16, fixed_dt);
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+    recording = true;
+    recording_start = std::chrono::steady_clock::now();
+    num_recorded_events = 0;
+    return static_cast<bool>(out);
+}
+
+void InputRecorder::stop_recording() {
+    if (recording) {
+        out.close();
+        recording = false;
+    }
+}
+
+void InputRecorder::record_key(int key, int scancode, int action, int mods,
+                               std::chrono::steady_clock::time_point arrival_time) {
+    write_event({0, 0, RecordedInputEventType::key, current_phase, key, scancode, action, mods, 0, 0}, arrival_time);
+}
+
+void InputRecorder::record_mouse_button(int button, int action, int mods,
+                                        std::chrono::steady_clock::time_point arrival_time) {
+    write_event({0, 0, RecordedInputEventType::mouse_button, current_phase, button, 0, action, mods, 0, 0},
+                arrival_time);
+}
+
+void InputRecorder::record_cursor_pos(double x, double y, std::chrono::steady_clock::time_point arrival_time) {
+    write_event({0, 0, RecordedInputEventType::cursor_pos, current_phase, 0, 0, 0, 0, x, y}, arrival_time);
+}
+
+void InputRecorder::write_event(RecordedInputEvent event, std::chrono::steady_clock::time_point arrival_time) {
+    if (!recording) {
+        return;
+    }
+
+    event.tick_index = current_tick_index;
+    event.time_seconds = std::chrono::duration<double>(arrival_time - recording_start).count();
+
+    std::uint8_t record[InputReplay::record_size] = {};
+    write_u64(record, event.tick_index);
+    write_f64(record + 8, event.time_seconds);
+    record[16] = static_cast<std::uint8_t>(event.type);
+    record[17] = static_cast<std::uint8_t>(event.phase);
+    if (event.type == RecordedInputEventType::cursor_pos) {
+        write_f64(record + 18, event.x);
+        write_f64(record + 26, event.y);
+    } else {
+        write_u32(record + 18, static_cast<std::uint32_t>(event.key));
+        write_u32(record + 22, static_cast<std::uint32_t>(event.scancode));
+        write_u32(record + 26, static_cast<std::uint32_t>(event.action));
+        write_u32(record + 30, static_cast<std::uint32_t>(event.mods));
+    }
+
+    out.write(reinterpret_cast<const char *>(record), sizeof(record));
+    num_recorded_events++;
+}
+
+bool MemoryMappedFile::open(const std::string &file_path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) or file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_handle = file;
+    mapping_handle = mapping;
+    data = static_cast<const std::uint8_t *>(view);
+    size = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 or file_stat.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // NOTE: the mapping keeps its own reference to the file so the descriptor isn't needed anymore
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    madvise(mapped, file_stat.st_size, MADV_SEQUENTIAL);
+    data = static_cast<const std::uint8_t *>(mapped);
+    size = static_cast<std::size_t>(file_stat.st_size);
+#endif
+    return true;
+}
+
+void MemoryMappedFile::close() {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping_handle);
+    CloseHandle(file_handle);
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    munmap(const_cast<std::uint8_t *>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+bool InputReplay::start_replay(const std::string &file_path) {
+    stop_replay();
+
+    if (!recording.open(file_path)) {
+        return false;
+    }
+
+    const std::uint8_t *header = recording.get_data();
+    bool valid_header = recording.get_size() >= header_size and
+                        std::memcmp(header, recording_magic, sizeof(recording_magic)) == 0 and
+                        read_u32(header + 8) == recording_version;
+    if (!valid_header) {
+        recording.close();
+        return false;
+    }
+
+    // NOTE: a recording that was cut off mid write, eg by a crash, ends in part of a record, everything before it
+    // is still replayed but the partial record is never read
+    std::size_t num_whole_records = (recording.get_size() - header_size) / record_size;
+    records_end_offset = header_size + num_whole_records * record_size;
+
+    fixed_dt = read_f64(header + 16);
+    next_record_offset = header_size;
+    active = true;
+    return true;
+}
+
+void InputReplay::stop_replay() {
+    recording.close();
+    active = false;
+    next_record_offset = 0;
+    records_end_offset = 0;
+}
+
+bool InputReplay::peek_next_event(RecordedInputEvent &event) const {
+    if (is_finished()) {
+        return false;
+    }
+
+    const std::uint8_t *record = recording.get_data() + next_record_offset;
+    event.tick_index = read_u64(record);
+    event.time_seconds = read_f64(record + 8);
+    event.type = static_cast<RecordedInputEventType>(record[16]);
+    event.phase = static_cast<TickPhase>(record[17]);
+    if (event.type == RecordedInputEventType::cursor_pos) {
+        event.key = event.scancode = event.action = event.mods = 0;
+        event.x = read_f64(record + 18);
+        event.y = read_f64(record + 26);
+    } else {
+        event.key = static_cast<std::int32_t>(read_u32(record + 18));
+        event.scancode = static_cast<std::int32_t>(read_u32(record + 22));
+        event.action = static_cast<std::int32_t>(read_u32(record + 26));
+        event.mods = static_cast<std::int32_t>(read_u32(record + 30));
+        event.x = event.y = 0;
+    }
+    return true;
+}
+
+} // namespace tbx_engine
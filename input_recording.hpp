@@ -0,0 +1,153 @@
+#ifndef INPUT_RECORDING_HPP
+#define INPUT_RECORDING_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace tbx_engine {
+
+enum class RecordedInputEventType : std::uint8_t { key, mouse_button, cursor_pos };
+
+/// whether an event arrived before or after the user's update function ran in its tick, this is what lets a replay
+/// apply events at exactly the same point in the tick as they happened live
+enum class TickPhase : std::uint8_t { before_update, after_update };
+
+/**
+ * @brief a single glfw input event as it is stored in a recording
+ *
+ * key events use key, scancode, action and mods, mouse button events use key as the button along with action and mods,
+ * cursor events use x and y
+ */
+struct RecordedInputEvent {
+    std::uint64_t tick_index;
+    double time_seconds;
+    RecordedInputEventType type;
+    TickPhase phase;
+    std::int32_t key, scancode, action, mods;
+    double x, y;
+};
+
+/**
+ * @brief writes every input event that passes through the glfw callbacks into a compact binary file
+ *
+ * the file starts with a header holding the fixed dt the recording should be replayed with, followed by fixed size
+ * little endian records, the key fields and the cursor position share the same bytes in a record since an event only
+ * ever uses one of them, events are buffered and only hit the disk when the buffer fills up
+ *
+ */
+class InputRecorder {
+  public:
+    bool start_recording(const std::string &file_path, double fixed_dt);
+    void stop_recording();
+    bool is_recording() const { return recording; }
+
+    /// events recorded after this call are attributed to this tick and phase
+    void set_position(std::uint64_t tick_index, TickPhase phase) {
+        current_tick_index = tick_index;
+        current_phase = phase;
+    }
+
+    /// @param arrival_time when the event came in from glfw, events that were queued before being recorded pass the
+    /// time they were queued so the recording doesn't get the time they were drained instead
+    void record_key(int key, int scancode, int action, int mods,
+                    std::chrono::steady_clock::time_point arrival_time = std::chrono::steady_clock::now());
+    void record_mouse_button(int button, int action, int mods,
+                             std::chrono::steady_clock::time_point arrival_time = std::chrono::steady_clock::now());
+    void record_cursor_pos(double x, double y,
+                           std::chrono::steady_clock::time_point arrival_time = std::chrono::steady_clock::now());
+
+    std::uint64_t get_num_recorded_events() const { return num_recorded_events; }
+
+  private:
+    void write_event(RecordedInputEvent event, std::chrono::steady_clock::time_point arrival_time);
+
+    bool recording = false;
+    std::ofstream out;
+    std::chrono::steady_clock::time_point recording_start;
+    std::uint64_t current_tick_index = 0;
+    TickPhase current_phase = TickPhase::before_update;
+    std::uint64_t num_recorded_events = 0;
+};
+
+/**
+ * @brief a read only view of a whole file through the os's virtual memory, pages are only read from disk when they
+ * are touched so opening a large file is cheap
+ */
+class MemoryMappedFile {
+  public:
+    MemoryMappedFile() = default;
+    ~MemoryMappedFile() { close(); }
+    MemoryMappedFile(const MemoryMappedFile &) = delete;
+    MemoryMappedFile &operator=(const MemoryMappedFile &) = delete;
+
+    bool open(const std::string &file_path);
+    void close();
+    bool is_open() const { return data != nullptr; }
+
+    const std::uint8_t *get_data() const { return data; }
+    std::size_t get_size() const { return size; }
+
+  private:
+    const std::uint8_t *data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+};
+
+/**
+ * @brief streams the events of a recording back tick by tick from a memory mapped file
+ *
+ * records are decoded one at a time as the replay reaches them, so the whole file is never loaded and an hour long
+ * recording replays as fast as the main loop can run
+ *
+ */
+class InputReplay {
+  public:
+    bool start_replay(const std::string &file_path);
+    void stop_replay();
+
+    bool is_active() const { return active; }
+    /// true once every event in the recording has been replayed, a partly written record at the end of the file,
+    /// eg from a crash while recording, doesn't count as an event
+    bool is_finished() const { return next_record_offset + record_size > records_end_offset; }
+
+    /// the dt that each tick of the replay should be given, this is what makes the replay deterministic
+    double get_fixed_dt() const { return fixed_dt; }
+
+    /// calls replay_event for every recorded event up to and including this tick and phase, in the order they were
+    /// recorded
+    template <typename EventReplayer>
+    void replay_events(std::uint64_t tick_index, TickPhase phase, EventReplayer &&replay_event) {
+        RecordedInputEvent event;
+        while (active and peek_next_event(event)) {
+            bool event_is_later = event.tick_index > tick_index or (event.tick_index == tick_index and
+                                                                    event.phase > phase);
+            if (event_is_later) {
+                break;
+            }
+            replay_event(event);
+            next_record_offset += record_size;
+        }
+    }
+
+    static constexpr std::size_t record_size = 34;
+    static constexpr std::size_t header_size = 24;
+
+  private:
+    bool peek_next_event(RecordedInputEvent &event) const;
+
+    bool active = false;
+    MemoryMappedFile recording;
+    std::size_t next_record_offset = 0;
+    /// one past the last whole record in the file
+    std::size_t records_end_offset = 0;
+    double fixed_dt = 0;
+};
+
+} // namespace tbx_engine
+
+#endif // INPUT_RECORDING_HPP
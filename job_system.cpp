@@ -0,0 +1,303 @@
+#include "job_system.hpp"
+
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+namespace tbx_engine {
+
+namespace {
+
+constexpr std::size_t not_a_worker = std::numeric_limits<std::size_t>::max();
+
+thread_local const JobSystem *this_threads_job_system = nullptr;
+thread_local std::size_t this_threads_worker_index = not_a_worker;
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void keep_first_exception(std::mutex &exception_mutex, std::exception_ptr &first_exception) {
+    std::lock_guard<std::mutex> lock(exception_mutex);
+    if (not first_exception) {
+        first_exception = std::current_exception();
+    }
+}
+
+void rethrow_and_clear_exception_if_any(std::mutex &exception_mutex, std::exception_ptr &first_exception) {
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(exception_mutex);
+        std::swap(exception, first_exception);
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+} // namespace
+
+std::size_t JobSystem::get_default_num_worker_threads() {
+    unsigned int num_hardware_threads = std::thread::hardware_concurrency();
+    return num_hardware_threads > 1 ? num_hardware_threads - 1 : 0;
+}
+
+JobSystem::JobSystem(std::size_t num_worker_threads) {
+    stats_reset_ns.store(now_ns());
+    for (std::size_t i = 0; i < num_worker_threads; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+}
+
+void JobSystem::start_worker_threads() {
+    // NOTE: the threads are only started once every worker exists because they steal from each other
+    for (std::size_t i = 0; i < workers.size(); i++) {
+        workers[i]->thread = std::thread([this, i]() { worker_loop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stopping.store(true);
+    }
+    wake_condition.notify_all();
+    for (auto &worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void JobSystem::submit(Job job, JobGroup *job_group) {
+    std::call_once(worker_threads_started, [this]() { start_worker_threads(); });
+    if (job_group != nullptr) {
+        job_group->num_unfinished_jobs.fetch_add(1, std::memory_order_relaxed);
+    }
+    num_unfinished_jobs.fetch_add(1, std::memory_order_relaxed);
+
+    if (this_threads_job_system == this) {
+        Worker &worker = *workers[this_threads_worker_index];
+        std::lock_guard<std::mutex> lock(worker.deque_mutex);
+        worker.jobs.emplace_back(std::move(job), job_group);
+    } else {
+        std::lock_guard<std::mutex> lock(shared_jobs_mutex);
+        shared_jobs.emplace_back(std::move(job), job_group);
+    }
+
+    num_queued_jobs.fetch_add(1, std::memory_order_release);
+    {
+        // NOTE: taking the lock here is what prevents a worker from missing this wake up between checking for jobs and
+        // going to sleep
+        std::lock_guard<std::mutex> lock(wake_mutex);
+    }
+    wake_condition.notify_one();
+}
+
+void JobSystem::wait(JobGroup &job_group) {
+    std::size_t worker_index = this_threads_job_system == this ? this_threads_worker_index : not_a_worker;
+    while (not job_group.is_done()) {
+        if (not try_run_one_job(worker_index)) {
+            std::this_thread::yield();
+        }
+    }
+    rethrow_and_clear_exception_if_any(job_group.exception_mutex, job_group.exception);
+}
+
+void JobSystem::wait_for_all() {
+    std::size_t worker_index = this_threads_job_system == this ? this_threads_worker_index : not_a_worker;
+    while (num_unfinished_jobs.load(std::memory_order_acquire) != 0) {
+        if (not try_run_one_job(worker_index)) {
+            std::this_thread::yield();
+        }
+    }
+    rethrow_and_clear_exception_if_any(ungrouped_job_exception_mutex, ungrouped_job_exception);
+}
+
+JobSystemStats JobSystem::get_stats() const {
+    JobSystemStats stats;
+    stats.num_worker_threads = workers.size();
+    stats.num_jobs_run = num_jobs_run.load(std::memory_order_relaxed);
+    stats.num_jobs_stolen = num_jobs_stolen.load(std::memory_order_relaxed);
+
+    double elapsed_ns = static_cast<double>(now_ns() - stats_reset_ns.load(std::memory_order_relaxed));
+    if (not workers.empty() and elapsed_ns > 0) {
+        double total_busy_ns = 0;
+        for (const auto &worker : workers) {
+            total_busy_ns += worker->busy_ns.load(std::memory_order_relaxed);
+        }
+        stats.worker_utilization = std::min(1.0, total_busy_ns / (elapsed_ns * workers.size()));
+    }
+    return stats;
+}
+
+void JobSystem::reset_stats() {
+    num_jobs_run.store(0, std::memory_order_relaxed);
+    num_jobs_stolen.store(0, std::memory_order_relaxed);
+    for (auto &worker : workers) {
+        worker->busy_ns.store(0, std::memory_order_relaxed);
+    }
+    stats_reset_ns.store(now_ns(), std::memory_order_relaxed);
+}
+
+void JobSystem::worker_loop(std::size_t worker_index) {
+    this_threads_job_system = this;
+    this_threads_worker_index = worker_index;
+
+    while (not stopping.load(std::memory_order_acquire)) {
+        if (try_run_one_job(worker_index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake_condition.wait(lock, [&]() {
+            return stopping.load(std::memory_order_acquire) or num_queued_jobs.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+bool JobSystem::try_run_one_job(std::size_t worker_index) {
+    std::pair<Job, JobGroup *> job;
+    if (not try_pop_job(worker_index, job)) {
+        return false;
+    }
+    num_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+
+    if (worker_index != not_a_worker) {
+        std::int64_t start_ns = now_ns();
+        run_job(job);
+        workers[worker_index]->busy_ns.fetch_add(now_ns() - start_ns, std::memory_order_relaxed);
+    } else {
+        run_job(job);
+    }
+    return true;
+}
+
+bool JobSystem::try_pop_job(std::size_t worker_index, std::pair<Job, JobGroup *> &job) {
+    if (worker_index != not_a_worker) {
+        Worker &worker = *workers[worker_index];
+        std::lock_guard<std::mutex> lock(worker.deque_mutex);
+        if (not worker.jobs.empty()) {
+            job = std::move(worker.jobs.back());
+            worker.jobs.pop_back();
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shared_jobs_mutex);
+        if (not shared_jobs.empty()) {
+            job = std::move(shared_jobs.front());
+            shared_jobs.pop_front();
+            return true;
+        }
+    }
+
+    // NOTE: victims are visited starting from our right hand neighbour so workers don't all hammer the same deque
+    std::size_t num_workers = workers.size();
+    std::size_t first_victim = worker_index == not_a_worker ? 0 : worker_index + 1;
+    for (std::size_t i = 0; i < num_workers; i++) {
+        std::size_t victim_index = (first_victim + i) % num_workers;
+        if (victim_index == worker_index) {
+            continue;
+        }
+        Worker &victim = *workers[victim_index];
+        std::lock_guard<std::mutex> lock(victim.deque_mutex);
+        if (not victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            num_jobs_stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::run_job(std::pair<Job, JobGroup *> &job) {
+    try {
+        job.first();
+    } catch (...) {
+        if (job.second != nullptr) {
+            keep_first_exception(job.second->exception_mutex, job.second->exception);
+        } else {
+            keep_first_exception(ungrouped_job_exception_mutex, ungrouped_job_exception);
+        }
+    }
+
+    num_jobs_run.fetch_add(1, std::memory_order_relaxed);
+    if (job.second != nullptr) {
+        job.second->num_unfinished_jobs.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    num_unfinished_jobs.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+TaskGraph::TaskId TaskGraph::add_task(std::string name, Job job) {
+    tasks.push_back({std::move(name), std::move(job), {}, 0});
+    return tasks.size() - 1;
+}
+
+void TaskGraph::add_dependency(TaskId task, TaskId dependency) {
+    tasks[dependency].dependents.push_back(task);
+    tasks[task].num_dependencies++;
+}
+
+void TaskGraph::run(JobSystem &job_system) {
+    if (has_cycle()) {
+        throw std::logic_error("the task graph contains a dependency cycle");
+    }
+
+    num_unfinished_dependencies = std::make_unique<std::atomic<std::size_t>[]>(tasks.size());
+    for (TaskId task = 0; task < tasks.size(); task++) {
+        num_unfinished_dependencies[task].store(tasks[task].num_dependencies, std::memory_order_relaxed);
+    }
+
+    JobGroup job_group;
+    for (TaskId task = 0; task < tasks.size(); task++) {
+        if (tasks[task].num_dependencies == 0) {
+            submit_task(job_system, job_group, task);
+        }
+    }
+    job_system.wait(job_group);
+}
+
+void TaskGraph::submit_task(JobSystem &job_system, JobGroup &job_group, TaskId task) {
+    // NOTE: dependents are submitted from inside the job, before it counts as finished, so the group can't reach zero
+    // while there is still work left to submit
+    job_system.submit(
+        [this, &job_system, &job_group, task]() {
+            tasks[task].job();
+            for (TaskId dependent : tasks[task].dependents) {
+                if (num_unfinished_dependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    submit_task(job_system, job_group, dependent);
+                }
+            }
+        },
+        &job_group);
+}
+
+bool TaskGraph::has_cycle() const {
+    // NOTE: kahn's algorithm, if some tasks can never reach zero dependencies they are part of a cycle
+    std::vector<std::size_t> remaining_dependencies(tasks.size());
+    std::vector<TaskId> ready;
+    for (TaskId task = 0; task < tasks.size(); task++) {
+        remaining_dependencies[task] = tasks[task].num_dependencies;
+        if (remaining_dependencies[task] == 0) {
+            ready.push_back(task);
+        }
+    }
+
+    std::size_t num_visited = 0;
+    while (not ready.empty()) {
+        TaskId task = ready.back();
+        ready.pop_back();
+        num_visited++;
+        for (TaskId dependent : tasks[task].dependents) {
+            if (--remaining_dependencies[dependent] == 0) {
+                ready.push_back(dependent);
+            }
+        }
+    }
+    return num_visited != tasks.size();
+}
+
+} // namespace tbx_engine
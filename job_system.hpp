@@ -0,0 +1,185 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tbx_engine {
+
+using Job = std::function<void()>;
+
+/// counts the unfinished jobs that were submitted with it, used to wait for a specific set of jobs
+struct JobGroup {
+    std::atomic<std::size_t> num_unfinished_jobs{0};
+    bool is_done() const { return num_unfinished_jobs.load(std::memory_order_acquire) == 0; }
+
+    /// the first exception thrown by one of the group's jobs, kept until the wait on this group rethrows it
+    std::mutex exception_mutex;
+    std::exception_ptr exception;
+};
+
+struct JobSystemStats {
+    std::size_t num_worker_threads = 0;
+    std::uint64_t num_jobs_run = 0;
+    std::uint64_t num_jobs_stolen = 0;
+    /// the fraction of time the workers spent running jobs since the stats were last reset, between 0 and 1
+    double worker_utilization = 0;
+};
+
+/**
+ * @brief a pool of worker threads sized to the hardware which share work by stealing it from each other
+ *
+ * every worker has its own deque, it pushes and pops at the back while idle workers steal from the front of
+ * somebody else's, jobs submitted from a non worker thread go into a shared queue, a thread which waits on jobs
+ * runs jobs itself while it waits instead of blocking, so the main thread contributes too and the system still works
+ * when there are no worker threads at all
+ *
+ * if a job throws, its exception belongs to the job's group, the first one of a group is rethrown by the wait on that
+ * group and the first one of the jobs submitted without a group by the next wait_for_all, so a failure in one part of
+ * the frame's work is reported where that part is waited on and not by whichever wait happens to run next
+ *
+ * the worker threads are only started by the first submit, so an engine that never submits a job has no idle threads
+ *
+ */
+class JobSystem {
+  public:
+    /// one worker per hardware thread minus one for the main thread
+    static std::size_t get_default_num_worker_threads();
+
+    explicit JobSystem(std::size_t num_worker_threads = get_default_num_worker_threads());
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    void submit(Job job, JobGroup *job_group = nullptr);
+
+    /// runs jobs on the calling thread until every job in job_group has finished
+    void wait(JobGroup &job_group);
+
+    /// runs jobs on the calling thread until every submitted job has finished, the engine calls this once per frame
+    /// after the user's update so no job is still writing to data that is about to be drawn
+    /// @note don't call this from inside a job, the calling job would be waiting on itself
+    void wait_for_all();
+
+    /**
+     * @brief calls func(i) for every i in [begin, end) spread across the workers and waits for them all
+     * @param grain_size how many consecutive indices one job handles, 0 picks one so every thread gets a few jobs
+     */
+    template <typename IndexFunc>
+    void parallel_for(std::size_t begin, std::size_t end, IndexFunc &&func, std::size_t grain_size = 0) {
+        if (end <= begin) {
+            return;
+        }
+        std::size_t num_indices = end - begin;
+        if (grain_size == 0) {
+            std::size_t num_jobs_wanted = (get_num_worker_threads() + 1) * 4;
+            grain_size = std::max<std::size_t>(1, num_indices / num_jobs_wanted);
+        }
+
+        JobGroup job_group;
+        for (std::size_t chunk_begin = begin; chunk_begin < end; chunk_begin += grain_size) {
+            std::size_t chunk_end = std::min(end, chunk_begin + grain_size);
+            submit(
+                [&func, chunk_begin, chunk_end]() {
+                    for (std::size_t i = chunk_begin; i < chunk_end; i++) {
+                        func(i);
+                    }
+                },
+                &job_group);
+        }
+        wait(job_group);
+    }
+
+    std::size_t get_num_worker_threads() const { return workers.size(); }
+
+    JobSystemStats get_stats() const;
+    void reset_stats();
+
+  private:
+    struct Worker {
+        std::mutex deque_mutex;
+        std::deque<std::pair<Job, JobGroup *>> jobs;
+        std::thread thread;
+        std::atomic<std::uint64_t> busy_ns{0};
+    };
+
+    void start_worker_threads();
+    void worker_loop(std::size_t worker_index);
+    /// @return true if a job was found and run
+    bool try_run_one_job(std::size_t worker_index);
+    bool try_pop_job(std::size_t worker_index, std::pair<Job, JobGroup *> &job);
+    void run_job(std::pair<Job, JobGroup *> &job);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::once_flag worker_threads_started;
+
+    std::mutex shared_jobs_mutex;
+    std::deque<std::pair<Job, JobGroup *>> shared_jobs;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_condition;
+    std::atomic<bool> stopping{false};
+
+    std::atomic<std::size_t> num_queued_jobs{0};
+    std::atomic<std::size_t> num_unfinished_jobs{0};
+    std::atomic<std::uint64_t> num_jobs_run{0};
+    std::atomic<std::uint64_t> num_jobs_stolen{0};
+    std::atomic<std::int64_t> stats_reset_ns{0};
+
+    /// the first exception thrown by a job that was submitted without a group
+    std::mutex ungrouped_job_exception_mutex;
+    std::exception_ptr ungrouped_job_exception;
+};
+
+/**
+ * @brief a set of tasks with dependencies between them which runs on a JobSystem
+ *
+ * a task is submitted as soon as every task it depends on has finished, so independent branches of the graph run in
+ * parallel, the graph can be run again once the previous run has finished
+ *
+ */
+class TaskGraph {
+  public:
+    using TaskId = std::size_t;
+
+    TaskId add_task(std::string name, Job job);
+
+    /// makes task wait for dependency to finish before it starts
+    void add_dependency(TaskId task, TaskId dependency);
+
+    /// runs every task and returns once they have all finished
+    /// @throws std::logic_error if the dependencies contain a cycle
+    void run(JobSystem &job_system);
+
+    const std::string &get_task_name(TaskId task) const { return tasks[task].name; }
+    std::size_t size() const { return tasks.size(); }
+
+  private:
+    struct Task {
+        std::string name;
+        Job job;
+        std::vector<TaskId> dependents;
+        std::size_t num_dependencies = 0;
+    };
+
+    void submit_task(JobSystem &job_system, JobGroup &job_group, TaskId task);
+    bool has_cycle() const;
+
+    std::vector<Task> tasks;
+    std::unique_ptr<std::atomic<std::size_t>[]> num_unfinished_dependencies;
+};
+
+} // namespace tbx_engine
+
+#endif // JOB_SYSTEM_HPP
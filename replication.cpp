@@ -0,0 +1,579 @@
+#include "replication.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace tbx_engine {
+
+namespace {
+constexpr std::uint32_t protocol_id = 0x52584254; // "TBXR"
+
+using PacketType = ReplicationPacketType;
+constexpr int packet_type_bits = 2;
+
+constexpr float pi = std::numbers::pi_v<float>;
+
+// NOTE: large enough for any packet, anything longer is cut off by the socket and then fails to parse
+constexpr std::size_t max_receive_size = 2048;
+
+void write_packet_header(BitWriter &writer, PacketType packet_type) {
+    writer.write_bits(protocol_id, 32);
+    writer.write_bits(static_cast<std::uint32_t>(packet_type), packet_type_bits);
+}
+
+std::optional<PacketType> read_packet_header(BitReader &reader) {
+    if (reader.read_bits(32) != protocol_id) {
+        return std::nullopt;
+    }
+    auto packet_type = static_cast<PacketType>(reader.read_bits(packet_type_bits));
+    if (reader.has_overflowed()) {
+        return std::nullopt;
+    }
+    return packet_type;
+}
+
+/// true if tick a comes after tick b, allowing for the counter wrapping around
+bool is_tick_newer(std::uint32_t a, std::uint32_t b) { return static_cast<std::int32_t>(a - b) > 0; }
+
+std::uint32_t quantize_angle(float angle, int num_bits) {
+    return quantize_float(std::remainder(angle, 2 * pi), -pi, pi, num_bits);
+}
+
+/// ids are mostly handed out in order so the gap to the previous record's id is usually tiny
+void write_entity_id(BitWriter &writer, std::uint32_t id, std::uint32_t &next_id) {
+    std::uint32_t gap = id - next_id;
+    if (gap < 64) {
+        writer.write_bool(true);
+        writer.write_bits(gap, 6);
+    } else {
+        writer.write_bool(false);
+        writer.write_bits(id, 32);
+    }
+    next_id = id + 1;
+}
+
+std::uint32_t read_entity_id(BitReader &reader, std::uint32_t &next_id) {
+    std::uint32_t id = reader.read_bool() ? next_id + reader.read_bits(6) : reader.read_bits(32);
+    next_id = id + 1;
+    return id;
+}
+
+void write_position(BitWriter &writer, const QuantizedEntity &entity, const ReplicationQuantization &quantization) {
+    for (std::uint32_t component : entity.position) {
+        writer.write_bits(component, quantization.position_bits);
+    }
+}
+
+void read_position(BitReader &reader, QuantizedEntity &entity, const ReplicationQuantization &quantization) {
+    for (std::uint32_t &component : entity.position) {
+        component = reader.read_bits(quantization.position_bits);
+    }
+}
+
+void write_angles(BitWriter &writer, const QuantizedEntity &entity, const ReplicationQuantization &quantization) {
+    writer.write_bits(entity.yaw, quantization.angle_bits);
+    writer.write_bits(entity.pitch, quantization.angle_bits);
+}
+
+void read_angles(BitReader &reader, QuantizedEntity &entity, const ReplicationQuantization &quantization) {
+    entity.yaw = reader.read_bits(quantization.angle_bits);
+    entity.pitch = reader.read_bits(quantization.angle_bits);
+}
+
+float lerp_angle(float from, float to, float t) { return from + std::remainder(to - from, 2 * pi) * t; }
+} // namespace
+
+QuantizedEntity quantize_entity(const ReplicatedEntity &entity, const ReplicationQuantization &quantization) {
+    QuantizedEntity quantized;
+    quantized.id = entity.id;
+    for (int i = 0; i < 3; i++) {
+        quantized.position[i] = quantize_float(entity.position[i], quantization.position_min,
+                                               quantization.position_max, quantization.position_bits);
+    }
+    quantized.yaw = quantize_angle(entity.yaw, quantization.angle_bits);
+    quantized.pitch = quantize_angle(entity.pitch, quantization.angle_bits);
+    quantized.flags = entity.flags & ((std::uint64_t(1) << quantization.flags_bits) - 1);
+    return quantized;
+}
+
+ReplicatedEntity dequantize_entity(const QuantizedEntity &entity, const ReplicationQuantization &quantization) {
+    ReplicatedEntity dequantized;
+    dequantized.id = entity.id;
+    for (int i = 0; i < 3; i++) {
+        dequantized.position[i] = dequantize_float(entity.position[i], quantization.position_min,
+                                                   quantization.position_max, quantization.position_bits);
+    }
+    dequantized.yaw = dequantize_float(entity.yaw, -pi, pi, quantization.angle_bits);
+    dequantized.pitch = dequantize_float(entity.pitch, -pi, pi, quantization.angle_bits);
+    dequantized.flags = entity.flags;
+    return dequantized;
+}
+
+void write_entity_delta(BitWriter &writer, const std::vector<QuantizedEntity> &baseline,
+                        const std::vector<QuantizedEntity> &target, const ReplicationQuantization &quantization,
+                        std::size_t max_bits, std::vector<QuantizedEntity> &received) {
+    // NOTE: the most a record can take, continue bit, id, removed bit, change bits and every field
+    const std::size_t max_record_bits =
+        1 + 33 + 1 + 3 + 3 * quantization.position_bits + 2 * quantization.angle_bits + quantization.flags_bits;
+    auto record_fits = [&]() { return writer.get_num_bits_written() + max_record_bits + 1 <= max_bits; };
+
+    received.clear();
+    std::uint32_t next_id = 0;
+    std::size_t i = 0, j = 0;
+    while (i < baseline.size() or j < target.size()) {
+        bool only_in_baseline = j == target.size() or (i < baseline.size() and baseline[i].id < target[j].id);
+        bool only_in_target = i == baseline.size() or (j < target.size() and target[j].id < baseline[i].id);
+
+        if (only_in_baseline) {
+            if (record_fits()) {
+                writer.write_bool(true);
+                write_entity_id(writer, baseline[i].id, next_id);
+                writer.write_bool(true);
+            } else {
+                received.push_back(baseline[i]);
+            }
+            i++;
+        } else if (only_in_target) {
+            if (record_fits()) {
+                writer.write_bool(true);
+                write_entity_id(writer, target[j].id, next_id);
+                writer.write_bool(false);
+                write_position(writer, target[j], quantization);
+                write_angles(writer, target[j], quantization);
+                writer.write_bits(target[j].flags, quantization.flags_bits);
+                received.push_back(target[j]);
+            }
+            j++;
+        } else {
+            const QuantizedEntity &before = baseline[i];
+            const QuantizedEntity &after = target[j];
+            if (before == after) {
+                received.push_back(after);
+            } else if (record_fits()) {
+                writer.write_bool(true);
+                write_entity_id(writer, after.id, next_id);
+                writer.write_bool(false);
+
+                bool position_changed = before.position != after.position;
+                bool angles_changed = before.yaw != after.yaw or before.pitch != after.pitch;
+                bool flags_changed = before.flags != after.flags;
+                writer.write_bool(position_changed);
+                writer.write_bool(angles_changed);
+                writer.write_bool(flags_changed);
+                if (position_changed) {
+                    write_position(writer, after, quantization);
+                }
+                if (angles_changed) {
+                    write_angles(writer, after, quantization);
+                }
+                if (flags_changed) {
+                    writer.write_bits(after.flags, quantization.flags_bits);
+                }
+                received.push_back(after);
+            } else {
+                received.push_back(before);
+            }
+            i++;
+            j++;
+        }
+    }
+    writer.write_bool(false);
+}
+
+bool read_entity_delta(BitReader &reader, const std::vector<QuantizedEntity> &baseline,
+                       const ReplicationQuantization &quantization, std::vector<QuantizedEntity> &result) {
+    result.clear();
+    std::uint32_t next_id = 0;
+    std::size_t i = 0;
+    while (reader.read_bool()) {
+        std::uint32_t id = read_entity_id(reader, next_id);
+        bool removed = reader.read_bool();
+
+        while (i < baseline.size() and baseline[i].id < id) {
+            result.push_back(baseline[i++]);
+        }
+        bool in_baseline = i < baseline.size() and baseline[i].id == id;
+
+        if (in_baseline) {
+            QuantizedEntity entity = baseline[i++];
+            if (removed) {
+                continue;
+            }
+            bool position_changed = reader.read_bool();
+            bool angles_changed = reader.read_bool();
+            bool flags_changed = reader.read_bool();
+            if (position_changed) {
+                read_position(reader, entity, quantization);
+            }
+            if (angles_changed) {
+                read_angles(reader, entity, quantization);
+            }
+            if (flags_changed) {
+                entity.flags = reader.read_bits(quantization.flags_bits);
+            }
+            result.push_back(entity);
+        } else {
+            if (removed) {
+                return false;
+            }
+            QuantizedEntity entity;
+            entity.id = id;
+            read_position(reader, entity, quantization);
+            read_angles(reader, entity, quantization);
+            entity.flags = reader.read_bits(quantization.flags_bits);
+            result.push_back(entity);
+        }
+
+        // NOTE: records come in increasing id order, anything else means the packet is corrupt
+        if (result.size() >= 2 and result[result.size() - 2].id >= result.back().id) {
+            return false;
+        }
+        if (reader.has_overflowed()) {
+            return false;
+        }
+    }
+    while (i < baseline.size()) {
+        result.push_back(baseline[i++]);
+    }
+    return not reader.has_overflowed();
+}
+
+void BandwidthMeter::update(double dt) {
+    window_elapsed_s += dt;
+    if (window_elapsed_s >= 1) {
+        bytes_per_second = bytes_this_window / window_elapsed_s;
+        bytes_this_window = 0;
+        window_elapsed_s = 0;
+    }
+}
+
+bool ReplicationServer::start(std::uint16_t port) {
+    clients.clear();
+    tick = 0;
+    time_s = 0;
+    return socket.open(port);
+}
+
+void ReplicationServer::stop() {
+    for (Client &client : clients) {
+        packet.clear();
+        BitWriter writer(packet);
+        write_packet_header(writer, PacketType::disconnect);
+        socket.send_to(client.endpoint, packet.data(), packet.size());
+    }
+    clients.clear();
+    socket.close();
+}
+
+std::vector<ReplicationClientStats> ReplicationServer::get_client_stats() const {
+    std::vector<ReplicationClientStats> client_stats;
+    for (const Client &client : clients) {
+        client_stats.push_back(client.stats);
+    }
+    return client_stats;
+}
+
+void ReplicationServer::update(double dt) {
+    if (not is_running()) {
+        return;
+    }
+    tick++;
+    time_s += dt;
+
+    receive_packets();
+
+    std::erase_if(clients, [&](const Client &client) { return time_s - client.last_heard_time_s > client_timeout_s; });
+
+    for (Client &client : clients) {
+        client.bandwidth_meter.update(dt);
+        client.stats.bytes_sent_per_second = client.bandwidth_meter.get_bytes_per_second();
+    }
+
+    if (clients.empty() or tick % std::max<std::uint32_t>(send_interval_ticks, 1) != 0) {
+        return;
+    }
+
+    quantized_entities.clear();
+    for (const ReplicatedEntity &entity : entities) {
+        quantized_entities.push_back(quantize_entity(entity, quantization));
+    }
+    std::sort(quantized_entities.begin(), quantized_entities.end(),
+              [](const QuantizedEntity &a, const QuantizedEntity &b) { return a.id < b.id; });
+
+    for (Client &client : clients) {
+        send_snapshot(client);
+    }
+}
+
+void ReplicationServer::receive_packets() {
+    std::array<std::uint8_t, max_receive_size> buffer;
+    NetworkEndpoint source;
+    while (auto num_bytes = socket.receive_from(source, buffer.data(), buffer.size())) {
+        BitReader reader(buffer.data(), *num_bytes);
+        std::optional<PacketType> packet_type = read_packet_header(reader);
+        if (not packet_type.has_value()) {
+            continue;
+        }
+
+        auto client = std::find_if(clients.begin(), clients.end(),
+                                   [&](const Client &client) { return client.endpoint == source; });
+
+        if (*packet_type == PacketType::hello and client == clients.end() and clients.size() < max_clients) {
+            // NOTE: a client is large because of its history, so it's built in place rather than copied in
+            clients.emplace_back();
+            clients.back().endpoint = source;
+            clients.back().stats.endpoint = source;
+            clients.back().last_heard_time_s = time_s;
+            continue;
+        }
+        if (client == clients.end()) {
+            continue;
+        }
+        client->last_heard_time_s = time_s;
+
+        if (*packet_type == PacketType::ack) {
+            std::uint32_t acked_tick = reader.read_bits(32);
+            if (not reader.has_overflowed() and
+                (not client->has_acked or is_tick_newer(acked_tick, client->stats.last_acked_tick))) {
+                client->has_acked = true;
+                client->stats.last_acked_tick = acked_tick;
+            }
+        } else if (*packet_type == PacketType::disconnect) {
+            clients.erase(client);
+        }
+    }
+}
+
+void ReplicationServer::send_snapshot(Client &client) {
+    static const std::vector<QuantizedEntity> no_entities;
+
+    const SentSnapshot *baseline = nullptr;
+    if (client.has_acked) {
+        for (const SentSnapshot &sent : client.history) {
+            if (sent.valid and sent.tick == client.stats.last_acked_tick) {
+                baseline = &sent;
+                break;
+            }
+        }
+    }
+
+    packet.clear();
+    BitWriter writer(packet);
+    write_packet_header(writer, PacketType::snapshot);
+    writer.write_bits(tick, 32);
+    writer.write_bits(static_cast<std::uint32_t>(std::llround(time_s * 1000)), 32);
+    writer.write_bool(baseline != nullptr);
+    if (baseline != nullptr) {
+        writer.write_bits(baseline->tick, 32);
+    } else {
+        client.stats.num_full_snapshots++;
+    }
+
+    // NOTE: written into a separate vector first since the slot about to be reused might be the baseline itself
+    write_entity_delta(writer, baseline != nullptr ? baseline->entities : no_entities, quantized_entities,
+                       quantization, max_packet_size * 8, received_entities);
+
+    SentSnapshot &slot = client.history[client.next_history_slot];
+    client.next_history_slot = (client.next_history_slot + 1) % history_size;
+    slot.tick = tick;
+    slot.valid = true;
+    std::swap(slot.entities, received_entities);
+
+    socket.send_to(client.endpoint, packet.data(), packet.size());
+    client.bandwidth_meter.add_bytes(packet.size());
+    client.stats.bytes_sent = client.bandwidth_meter.get_total_bytes();
+    client.stats.packets_sent++;
+}
+
+bool ReplicationClient::connect(const NetworkEndpoint &server) {
+    disconnect();
+    if (not socket.open(0)) {
+        return false;
+    }
+    server_endpoint = server;
+    history = {};
+    next_history_slot = 0;
+    buffered_snapshots.clear();
+    interpolated_entities.clear();
+    has_snapshot = false;
+    should_ack = false;
+    time_since_last_snapshot_s = 0;
+    render_time_s = 0;
+    latest_server_time_s = 0;
+    stats = {};
+    bandwidth_meter = {};
+
+    send_packet(PacketType::hello, 0);
+    time_since_hello_s = 0;
+    return true;
+}
+
+void ReplicationClient::disconnect() {
+    if (not is_running()) {
+        return;
+    }
+    send_packet(PacketType::disconnect, 0);
+    socket.close();
+    has_snapshot = false;
+}
+
+void ReplicationClient::send_packet(PacketType packet_type, std::uint32_t acked_tick) {
+    packet.clear();
+    BitWriter writer(packet);
+    write_packet_header(writer, packet_type);
+    if (packet_type == PacketType::ack) {
+        writer.write_bits(acked_tick, 32);
+    }
+    socket.send_to(server_endpoint, packet.data(), packet.size());
+}
+
+void ReplicationClient::update(double dt) {
+    if (not is_running()) {
+        return;
+    }
+    time_since_last_snapshot_s += dt;
+    time_since_hello_s += dt;
+
+    receive_packets();
+    bandwidth_meter.update(dt);
+    stats.bytes_received = bandwidth_meter.get_total_bytes();
+    stats.bytes_received_per_second = bandwidth_meter.get_bytes_per_second();
+
+    if (should_ack) {
+        send_packet(PacketType::ack, stats.latest_tick);
+        should_ack = false;
+    }
+    if (not is_connected() and time_since_hello_s >= hello_interval_s) {
+        send_packet(PacketType::hello, 0);
+        time_since_hello_s = 0;
+    }
+
+    if (buffered_snapshots.empty()) {
+        return;
+    }
+    // NOTE: render time moves with the local clock and is pulled gently towards the target so that snapshots
+    // arriving in bursts don't make it jump, only a large drift, eg after a stall, snaps it back
+    double target_render_time_s = latest_server_time_s - interpolation_delay_s;
+    render_time_s += dt;
+    if (std::abs(target_render_time_s - render_time_s) > 0.25) {
+        render_time_s = target_render_time_s;
+    } else {
+        render_time_s += (target_render_time_s - render_time_s) * 0.1;
+    }
+    interpolate();
+}
+
+void ReplicationClient::receive_packets() {
+    std::array<std::uint8_t, max_receive_size> buffer;
+    NetworkEndpoint source;
+    while (auto num_bytes = socket.receive_from(source, buffer.data(), buffer.size())) {
+        if (not(source == server_endpoint)) {
+            continue;
+        }
+        BitReader reader(buffer.data(), *num_bytes);
+        std::optional<PacketType> packet_type = read_packet_header(reader);
+        if (not packet_type.has_value()) {
+            continue;
+        }
+        bandwidth_meter.add_bytes(*num_bytes);
+
+        if (*packet_type == PacketType::snapshot) {
+            if (not receive_snapshot(reader)) {
+                stats.snapshots_dropped++;
+            }
+        } else if (*packet_type == PacketType::disconnect) {
+            has_snapshot = false;
+        }
+    }
+}
+
+bool ReplicationClient::receive_snapshot(BitReader &reader) {
+    static const std::vector<QuantizedEntity> no_entities;
+
+    std::uint32_t tick = reader.read_bits(32);
+    double server_time_s = reader.read_bits(32) / 1000.0;
+    bool has_baseline = reader.read_bool();
+    std::uint32_t baseline_tick = has_baseline ? reader.read_bits(32) : 0;
+    if (reader.has_overflowed() or (has_snapshot and not is_tick_newer(tick, stats.latest_tick))) {
+        return false;
+    }
+
+    const ReceivedSnapshot *baseline = nullptr;
+    if (has_baseline) {
+        for (const ReceivedSnapshot &received : history) {
+            if (received.valid and received.tick == baseline_tick) {
+                baseline = &received;
+                break;
+            }
+        }
+        if (baseline == nullptr) {
+            return false;
+        }
+    }
+
+    if (not read_entity_delta(reader, baseline != nullptr ? baseline->entities : no_entities, quantization,
+                              decoded_entities)) {
+        return false;
+    }
+
+    ReceivedSnapshot &slot = history[next_history_slot];
+    next_history_slot = (next_history_slot + 1) % history_size;
+    slot.tick = tick;
+    slot.valid = true;
+    std::swap(slot.entities, decoded_entities);
+
+    TimedSnapshot timed_snapshot{server_time_s, {}};
+    for (const QuantizedEntity &entity : slot.entities) {
+        timed_snapshot.entities.push_back(dequantize_entity(entity, quantization));
+    }
+    buffered_snapshots.push_back(std::move(timed_snapshot));
+    if (buffered_snapshots.size() > max_buffered_snapshots) {
+        buffered_snapshots.pop_front();
+    }
+
+    has_snapshot = true;
+    should_ack = true;
+    time_since_last_snapshot_s = 0;
+    latest_server_time_s = server_time_s;
+    stats.latest_tick = tick;
+    stats.snapshots_received++;
+    return true;
+}
+
+void ReplicationClient::interpolate() {
+    auto after = std::find_if(buffered_snapshots.begin(), buffered_snapshots.end(),
+                              [&](const TimedSnapshot &snapshot) { return snapshot.server_time_s > render_time_s; });
+
+    // NOTE: before the oldest or past the newest snapshot there's nothing to blend with, so the closest one is shown
+    if (after == buffered_snapshots.begin() or after == buffered_snapshots.end()) {
+        const TimedSnapshot &closest = after == buffered_snapshots.end() ? buffered_snapshots.back() : *after;
+        interpolated_entities = closest.entities;
+        return;
+    }
+
+    const TimedSnapshot &before = *std::prev(after);
+    float t = static_cast<float>((render_time_s - before.server_time_s) /
+                                 (after->server_time_s - before.server_time_s));
+
+    interpolated_entities.clear();
+    std::size_t i = 0;
+    for (const ReplicatedEntity &to : after->entities) {
+        while (i < before.entities.size() and before.entities[i].id < to.id) {
+            i++;
+        }
+        if (i == before.entities.size() or before.entities[i].id != to.id) {
+            // NOTE: the entity appeared between the two snapshots
+            interpolated_entities.push_back(to);
+            continue;
+        }
+        const ReplicatedEntity &from = before.entities[i];
+        ReplicatedEntity entity = to;
+        entity.position = from.position + (to.position - from.position) * t;
+        entity.yaw = lerp_angle(from.yaw, to.yaw, t);
+        entity.pitch = lerp_angle(from.pitch, to.pitch, t);
+        interpolated_entities.push_back(entity);
+    }
+}
+
+} // namespace tbx_engine
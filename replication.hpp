@@ -0,0 +1,243 @@
+#ifndef REPLICATION_HPP
+#define REPLICATION_HPP
+
+#include "sbpt_generated_includes.hpp"
+#include "bit_packing.hpp"
+#include "udp_socket.hpp"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace tbx_engine {
+
+enum class ReplicationPacketType : std::uint8_t { hello, ack, snapshot, disconnect };
+
+/// the state of one entity as the server sees it
+struct ReplicatedEntity {
+    std::uint32_t id = 0;
+    glm::vec3 position;
+    /// radians
+    float yaw = 0, pitch = 0;
+    /// game specific state, eg an animation or team, sent as is
+    std::uint32_t flags = 0;
+};
+
+/// how entities are squeezed onto the wire, the server and its clients must use the same settings
+struct ReplicationQuantization {
+    float position_min = -4096, position_max = 4096;
+    /// with the default range this is a precision of under a centimeter
+    int position_bits = 20;
+    int angle_bits = 12;
+    int flags_bits = 16;
+};
+
+/// an entity after quantization, changes are detected on these so noise below the precision is never sent
+struct QuantizedEntity {
+    std::uint32_t id = 0;
+    std::array<std::uint32_t, 3> position{};
+    std::uint32_t yaw = 0, pitch = 0, flags = 0;
+
+    bool operator==(const QuantizedEntity &other) const = default;
+};
+
+QuantizedEntity quantize_entity(const ReplicatedEntity &entity, const ReplicationQuantization &quantization);
+ReplicatedEntity dequantize_entity(const QuantizedEntity &entity, const ReplicationQuantization &quantization);
+
+/**
+ * @brief writes target as the changes from baseline, both sorted by id
+ *
+ * each record is an entity that was added, removed or changed, changed entities only carry the fields that differ,
+ * records are written until the next one might not fit in max_bits, the rest are left for a later snapshot
+ *
+ * @param received the entities the receiver will have after reading this, which is the baseline with the records
+ * that fit applied, this is what the next delta has to be based on
+ */
+void write_entity_delta(BitWriter &writer, const std::vector<QuantizedEntity> &baseline,
+                        const std::vector<QuantizedEntity> &target, const ReplicationQuantization &quantization,
+                        std::size_t max_bits, std::vector<QuantizedEntity> &received);
+
+/// @return false if the data is malformed
+bool read_entity_delta(BitReader &reader, const std::vector<QuantizedEntity> &baseline,
+                       const ReplicationQuantization &quantization, std::vector<QuantizedEntity> &result);
+
+/// counts bytes over one second windows
+class BandwidthMeter {
+  public:
+    void add_bytes(std::size_t num_bytes) {
+        total_bytes += num_bytes;
+        bytes_this_window += num_bytes;
+    }
+    void update(double dt);
+
+    std::uint64_t get_total_bytes() const { return total_bytes; }
+    /// over the last full second
+    double get_bytes_per_second() const { return bytes_per_second; }
+
+  private:
+    std::uint64_t total_bytes = 0;
+    std::uint64_t bytes_this_window = 0;
+    double window_elapsed_s = 0;
+    double bytes_per_second = 0;
+};
+
+struct ReplicationClientStats {
+    NetworkEndpoint endpoint;
+    double bytes_sent_per_second = 0;
+    std::uint64_t bytes_sent = 0;
+    std::uint64_t packets_sent = 0;
+    /// the last tick the client confirmed having, deltas are made against it
+    std::uint32_t last_acked_tick = 0;
+    /// snapshots sent without a baseline because nothing acked was still remembered
+    std::uint64_t num_full_snapshots = 0;
+};
+
+/**
+ * @brief sends the authoritative state of every entity to each connected client, call update once per tick
+ *
+ * every client gets its own delta against the last snapshot it acknowledged, so only what changed since then is sent,
+ * if acks stop arriving the deltas simply grow until the client catches up, clients connect by sending a hello and are
+ * dropped after client_timeout_s of silence
+ *
+ */
+class ReplicationServer {
+  public:
+    /// @param port 0 picks a free one, see get_port
+    bool start(std::uint16_t port);
+    void stop();
+    bool is_running() const { return socket.is_open(); }
+    std::uint16_t get_port() const { return socket.get_local_port(); }
+
+    /// processes acks and connections and sends a snapshot of entities to every client
+    void update(double dt);
+
+    std::vector<ReplicationClientStats> get_client_stats() const;
+    std::size_t get_num_clients() const { return clients.size(); }
+    std::uint32_t get_tick() const { return tick; }
+
+    /// the state to send, fill it in during the tick, the order doesn't matter and ids must be unique
+    std::vector<ReplicatedEntity> entities;
+
+    ReplicationQuantization quantization;
+    /// a snapshot is sent every this many ticks
+    std::uint32_t send_interval_ticks = 1;
+    /// stay under the usual internet mtu so packets are never fragmented
+    std::size_t max_packet_size = 1200;
+    std::size_t max_clients = 64;
+    double client_timeout_s = 5;
+
+    /// set simulated_conditions on this to test with loss and latency
+    UdpSocket socket;
+
+  private:
+    static constexpr std::size_t history_size = 64;
+
+    struct SentSnapshot {
+        std::uint32_t tick = 0;
+        bool valid = false;
+        std::vector<QuantizedEntity> entities;
+    };
+
+    struct Client {
+        NetworkEndpoint endpoint;
+        double last_heard_time_s = 0;
+        bool has_acked = false;
+        ReplicationClientStats stats;
+        BandwidthMeter bandwidth_meter;
+        std::array<SentSnapshot, history_size> history;
+        std::size_t next_history_slot = 0;
+    };
+
+    void receive_packets();
+    void send_snapshot(Client &client);
+
+    std::vector<Client> clients;
+    std::vector<QuantizedEntity> quantized_entities;
+    std::vector<QuantizedEntity> received_entities;
+    std::vector<std::uint8_t> packet;
+    std::uint32_t tick = 0;
+    double time_s = 0;
+};
+
+struct ReplicationNetworkStats {
+    double bytes_received_per_second = 0;
+    std::uint64_t bytes_received = 0;
+    std::uint64_t snapshots_received = 0;
+    /// arrived after a newer one or referred to a baseline we no longer have
+    std::uint64_t snapshots_dropped = 0;
+    std::uint32_t latest_tick = 0;
+};
+
+/**
+ * @brief receives snapshots from a ReplicationServer and interpolates between them, call update once per tick
+ *
+ * entities are shown interpolation_delay_s behind the newest snapshot so there is almost always a snapshot on either
+ * side of the time being shown, a few lost packets then only make the motion a little less precise instead of jumpy
+ *
+ */
+class ReplicationClient {
+  public:
+    bool connect(const NetworkEndpoint &server);
+    void disconnect();
+    bool is_running() const { return socket.is_open(); }
+    /// true once a snapshot arrived within the last connection_timeout_s
+    bool is_connected() const { return has_snapshot and time_since_last_snapshot_s < connection_timeout_s; }
+
+    void update(double dt);
+
+    /// the entities as of the current render time, sorted by id
+    const std::vector<ReplicatedEntity> &get_interpolated_entities() const { return interpolated_entities; }
+    const ReplicationNetworkStats &get_stats() const { return stats; }
+
+    ReplicationQuantization quantization;
+    double interpolation_delay_s = 0.1;
+    double connection_timeout_s = 2;
+    /// while not connected a hello is sent this often
+    double hello_interval_s = 0.25;
+
+    /// set simulated_conditions on this to test with loss and latency
+    UdpSocket socket;
+
+  private:
+    static constexpr std::size_t history_size = 64;
+    static constexpr std::size_t max_buffered_snapshots = 32;
+
+    struct ReceivedSnapshot {
+        std::uint32_t tick = 0;
+        bool valid = false;
+        std::vector<QuantizedEntity> entities;
+    };
+
+    struct TimedSnapshot {
+        double server_time_s;
+        std::vector<ReplicatedEntity> entities;
+    };
+
+    void receive_packets();
+    bool receive_snapshot(BitReader &reader);
+    void send_packet(ReplicationPacketType packet_type, std::uint32_t acked_tick);
+    void interpolate();
+
+    NetworkEndpoint server_endpoint;
+    std::array<ReceivedSnapshot, history_size> history;
+    std::size_t next_history_slot = 0;
+    std::deque<TimedSnapshot> buffered_snapshots;
+    std::vector<ReplicatedEntity> interpolated_entities;
+    std::vector<QuantizedEntity> decoded_entities;
+
+    bool has_snapshot = false;
+    bool should_ack = false;
+    double time_since_last_snapshot_s = 0;
+    double time_since_hello_s = 0;
+    double render_time_s = 0;
+    double latest_server_time_s = 0;
+
+    BandwidthMeter bandwidth_meter;
+    ReplicationNetworkStats stats;
+    std::vector<std::uint8_t> packet;
+};
+
+} // namespace tbx_engine
+
+#endif // REPLICATION_HPP
@@ -0,0 +1,92 @@
+#include "engine_checks.hpp"
+#include "replication.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace tbx_engine {
+
+namespace {
+
+/// runs a server and a client over loopback for num_ticks ticks at 60 hz, every tenth entity moves
+void check_loopback(std::vector<CheckResult> &results, const std::string &name,
+                    const SimulatedNetworkConditions &conditions, int num_entities, int num_ticks) {
+    ReplicationServer server;
+    ReplicationClient client;
+    server.socket.simulated_conditions = conditions;
+    client.socket.simulated_conditions = conditions;
+    std::optional<NetworkEndpoint> server_endpoint;
+    if (server.start(0)) {
+        server_endpoint = NetworkEndpoint::from_string("127.0.0.1", server.get_port());
+    }
+    if (not server_endpoint.has_value() or not client.connect(*server_endpoint)) {
+        results.push_back({name + ": connect over loopback", false, "couldn't open the sockets"});
+        return;
+    }
+
+    const double dt = 1.0 / 60;
+    for (int tick = 0; tick < num_ticks; tick++) {
+        server.entities.clear();
+        for (int i = 0; i < num_entities; i++) {
+            float offset = i % 10 == 0 ? static_cast<float>(tick * dt * 3) : 0;
+            server.entities.push_back({static_cast<std::uint32_t>(i), glm::vec3(i + offset, 1, -i), 0.5f, 0.1f,
+                                       static_cast<std::uint32_t>(i)});
+        }
+        server.update(dt);
+        client.update(dt);
+        std::this_thread::sleep_for(std::chrono::duration<double>(dt));
+    }
+
+    const std::vector<ReplicatedEntity> &entities = client.get_interpolated_entities();
+    std::size_t num_wrong = 0;
+    for (const ReplicatedEntity &entity : entities) {
+        // NOTE: the moving entities are shown interpolation_delay_s in the past so only the still ones are compared
+        if (entity.id % 10 != 0 and (std::abs(entity.position.x - entity.id) > 0.01f or
+                                     std::abs(entity.position.z + entity.id) > 0.01f or entity.flags != entity.id)) {
+            num_wrong++;
+        }
+    }
+    std::vector<ReplicationClientStats> client_stats = server.get_client_stats();
+    results.push_back({name + ": the client sees every entity", client.is_connected() and
+                                                                    entities.size() == std::size_t(num_entities) and
+                                                                    num_wrong == 0,
+                       std::to_string(entities.size()) + " entities, " + std::to_string(num_wrong) + " wrong, " +
+                           std::to_string(client.get_stats().snapshots_dropped) + " snapshots dropped"});
+    if (not client_stats.empty()) {
+        results.back().detail += ", " + std::to_string(int(client_stats[0].bytes_sent_per_second)) + " B/s";
+    }
+
+    client.disconnect();
+    // NOTE: with loss the disconnect may never arrive, then the client is only dropped after client_timeout_s
+    if (conditions.loss_probability == 0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(conditions.latency_s + conditions.jitter_s + 0.01));
+        server.update(dt);
+        results.push_back({name + ": a disconnect removes the client", server.get_num_clients() == 0, ""});
+    }
+}
+
+} // namespace
+
+std::vector<CheckResult> run_replication_checks() {
+    std::vector<CheckResult> results;
+
+    std::vector<std::uint8_t> buffer;
+    BitWriter writer(buffer);
+    writer.write_bits(5, 3);
+    writer.write_bits(0xdeadbeef, 32);
+    writer.write_bool(true);
+    writer.write_bits(1234, 11);
+    BitReader reader(buffer.data(), buffer.size());
+    bool round_trip_matches = reader.read_bits(3) == 5 and reader.read_bits(32) == 0xdeadbeef and reader.read_bool() and
+                              reader.read_bits(11) == 1234 and not reader.has_overflowed();
+    results.push_back({"bit packing round trip", round_trip_matches, std::to_string(buffer.size()) + " bytes"});
+
+    check_loopback(results, "perfect network", {}, 100, 60);
+    check_loopback(results, "20% loss, 50 ms latency, 20 ms jitter", {0.2, 0.05, 0.02}, 100, 120);
+    check_loopback(results, "1000 entities, 5% loss", {0.05, 0.03, 0}, 1000, 120);
+
+    return results;
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,296 @@
+#include "sound_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tbx_engine {
+
+namespace {
+std::uint32_t read_u32_le(const unsigned char *bytes) {
+    return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | std::uint32_t(bytes[3]) << 24;
+}
+
+std::uint16_t read_u16_le(const unsigned char *bytes) { return bytes[0] | bytes[1] << 8; }
+
+constexpr std::uint16_t wave_format_pcm = 1;
+constexpr std::uint16_t wave_format_ieee_float = 3;
+constexpr std::uint16_t wave_format_extensible = 0xfffe;
+} // namespace
+
+bool WavReader::open(const std::string &path) {
+    file.close();
+    file.clear();
+    file.open(path, std::ios::binary);
+    if (not file.is_open()) {
+        return false;
+    }
+
+    unsigned char riff_header[12];
+    if (not file.read(reinterpret_cast<char *>(riff_header), sizeof(riff_header)) or
+        std::memcmp(riff_header, "RIFF", 4) != 0 or std::memcmp(riff_header + 8, "WAVE", 4) != 0) {
+        file.close();
+        return false;
+    }
+
+    bool found_format = false;
+    unsigned char chunk_header[8];
+    while (file.read(reinterpret_cast<char *>(chunk_header), sizeof(chunk_header))) {
+        std::uint32_t chunk_size = read_u32_le(chunk_header + 4);
+
+        if (std::memcmp(chunk_header, "fmt ", 4) == 0 and chunk_size >= 16) {
+            std::vector<unsigned char> format(chunk_size);
+            if (not file.read(reinterpret_cast<char *>(format.data()), chunk_size)) {
+                break;
+            }
+            std::uint16_t audio_format = read_u16_le(format.data());
+            // NOTE: the extensible header keeps the real format in the first two bytes of its sub format guid
+            if (audio_format == wave_format_extensible and chunk_size >= 26) {
+                audio_format = read_u16_le(format.data() + 24);
+            }
+            num_channels = read_u16_le(format.data() + 2);
+            sample_rate = read_u32_le(format.data() + 4);
+            bits_per_sample = read_u16_le(format.data() + 14);
+            is_float = audio_format == wave_format_ieee_float;
+
+            bool supported_pcm = audio_format == wave_format_pcm and
+                                 (bits_per_sample == 8 or bits_per_sample == 16 or bits_per_sample == 24 or
+                                  bits_per_sample == 32);
+            bool supported_float = is_float and bits_per_sample == 32;
+            found_format = (supported_pcm or supported_float) and num_channels > 0;
+        } else if (std::memcmp(chunk_header, "data", 4) == 0 and found_format) {
+            data_offset = file.tellg();
+            num_frames = chunk_size / (num_channels * (bits_per_sample / 8));
+            num_frames_read = 0;
+            return true;
+        } else {
+            file.seekg(chunk_size, std::ios::cur);
+        }
+        // NOTE: chunks are padded to an even size
+        if (chunk_size % 2 == 1) {
+            file.seekg(1, std::ios::cur);
+        }
+    }
+
+    file.close();
+    return false;
+}
+
+std::size_t WavReader::read_frames(std::int16_t *out, std::size_t max_frames) {
+    if (not is_open()) {
+        return 0;
+    }
+    std::size_t bytes_per_sample = bits_per_sample / 8;
+    std::size_t num_frames_to_read = std::min(max_frames, num_frames - num_frames_read);
+    raw_chunk.resize(num_frames_to_read * num_channels * bytes_per_sample);
+    file.read(raw_chunk.data(), raw_chunk.size());
+
+    std::size_t num_samples = static_cast<std::size_t>(file.gcount()) / bytes_per_sample;
+    num_samples -= num_samples % num_channels;
+    const auto *bytes = reinterpret_cast<const unsigned char *>(raw_chunk.data());
+
+    for (std::size_t i = 0; i < num_samples; i++) {
+        const unsigned char *sample = bytes + i * bytes_per_sample;
+        if (is_float) {
+            float value;
+            std::memcpy(&value, sample, sizeof(value));
+            out[i] = static_cast<std::int16_t>(std::clamp(value, -1.0f, 1.0f) * 32767);
+        } else if (bits_per_sample == 8) {
+            // NOTE: 8 bit wav is the only unsigned one
+            out[i] = static_cast<std::int16_t>((sample[0] - 128) * 256);
+        } else {
+            // NOTE: the two most significant bytes are the last two, the rest is precision we drop
+            out[i] = static_cast<std::int16_t>(read_u16_le(sample + bytes_per_sample - 2));
+        }
+    }
+
+    std::size_t num_frames_got = num_samples / num_channels;
+    num_frames_read += num_frames_got;
+    return num_frames_got;
+}
+
+bool WavReader::rewind() {
+    if (not is_open()) {
+        return false;
+    }
+    file.clear();
+    file.seekg(data_offset);
+    num_frames_read = 0;
+    return static_cast<bool>(file);
+}
+
+std::optional<DecodedSound> decode_wav_file(const std::string &path) {
+    WavReader reader;
+    if (not reader.open(path)) {
+        return std::nullopt;
+    }
+    DecodedSound sound;
+    sound.sample_rate = reader.get_sample_rate();
+    sound.num_channels = reader.get_num_channels();
+    sound.samples.resize(reader.get_num_frames() * sound.num_channels);
+    std::size_t num_frames = reader.read_frames(sound.samples.data(), reader.get_num_frames());
+    sound.samples.resize(num_frames * sound.num_channels);
+    return sound;
+}
+
+SoundCache::~SoundCache() {
+    {
+        std::lock_guard lock(mutex);
+        stop_prefetching = true;
+    }
+    prefetch_requested.notify_all();
+    if (prefetch_thread.joinable()) {
+        prefetch_thread.join();
+    }
+}
+
+void SoundCache::register_sound(const std::string &name, const std::string &path) {
+    std::lock_guard lock(mutex);
+    name_to_entry[name].path = path;
+}
+
+bool SoundCache::is_registered(const std::string &name) const {
+    std::lock_guard lock(mutex);
+    return name_to_entry.count(name) > 0;
+}
+
+bool SoundCache::is_resident(const std::string &name) const {
+    std::lock_guard lock(mutex);
+    auto it = name_to_entry.find(name);
+    return it != name_to_entry.end() and it->second.sound != nullptr;
+}
+
+std::shared_ptr<const DecodedSound> SoundCache::get(const std::string &name) {
+    std::unique_lock lock(mutex);
+    auto it = name_to_entry.find(name);
+    if (it == name_to_entry.end()) {
+        return nullptr;
+    }
+    // NOTE: entries are never erased and unordered_map doesn't move its elements, so this stays valid while unlocked
+    Entry &entry = it->second;
+    entry.num_requests++;
+    loading_finished.wait(lock, [&]() { return not entry.is_loading; });
+
+    if (entry.sound != nullptr) {
+        stats.num_hits++;
+        make_most_recently_used(entry);
+        return entry.sound;
+    }
+    stats.num_misses++;
+    return load(lock, entry, name);
+}
+
+std::shared_ptr<const DecodedSound> SoundCache::load(std::unique_lock<std::mutex> &lock, Entry &entry,
+                                                     const std::string &name) {
+    entry.is_loading = true;
+    std::string path = entry.path;
+
+    lock.unlock();
+    std::optional<DecodedSound> decoded = decode_wav_file(path);
+    lock.lock();
+
+    entry.is_loading = false;
+    entry.decode_failed = not decoded.has_value();
+    std::shared_ptr<const DecodedSound> sound;
+    if (decoded.has_value()) {
+        // NOTE: holding sound here keeps the eviction below from throwing out what was just loaded
+        sound = std::make_shared<const DecodedSound>(std::move(*decoded));
+        entry.sound = sound;
+        lru.push_front(name);
+        entry.lru_position = lru.begin();
+        stats.resident_bytes += sound->get_size_bytes();
+        stats.num_resident_sounds++;
+        evict_until_within_budget();
+    } else {
+        stats.num_decode_failures++;
+    }
+    loading_finished.notify_all();
+    return sound;
+}
+
+void SoundCache::make_most_recently_used(Entry &entry) {
+    lru.splice(lru.begin(), lru, entry.lru_position);
+}
+
+void SoundCache::evict_until_within_budget() {
+    auto it = lru.end();
+    while (stats.resident_bytes > memory_budget_bytes and it != lru.begin()) {
+        --it;
+        Entry &entry = name_to_entry.at(*it);
+        // NOTE: someone else holding the sound means it is being played, dropping our reference wouldn't free it
+        if (entry.sound.use_count() > 1) {
+            continue;
+        }
+        stats.resident_bytes -= entry.sound->get_size_bytes();
+        stats.num_resident_sounds--;
+        stats.num_evictions++;
+        entry.sound.reset();
+        it = lru.erase(it);
+    }
+}
+
+void SoundCache::prefetch(const std::string &name) {
+    std::lock_guard lock(mutex);
+    prefetch_locked(name);
+}
+
+void SoundCache::prefetch_locked(const std::string &name) {
+    auto it = name_to_entry.find(name);
+    if (it == name_to_entry.end() or it->second.sound != nullptr or it->second.is_loading) {
+        return;
+    }
+    // NOTE: marked as loading right away so a get in the meantime waits for the prefetch instead of decoding twice
+    it->second.is_loading = true;
+    prefetch_queue.push_back(name);
+    stats.num_prefetches++;
+    if (not prefetch_thread.joinable()) {
+        prefetch_thread = std::thread([this]() { prefetch_loop(); });
+    }
+    prefetch_requested.notify_one();
+}
+
+void SoundCache::prefetch_most_used(std::size_t num) {
+    std::lock_guard lock(mutex);
+    std::vector<std::pair<std::uint64_t, const std::string *>> candidates;
+    for (const auto &[name, entry] : name_to_entry) {
+        if (entry.sound == nullptr and not entry.is_loading and not entry.decode_failed and entry.num_requests > 0) {
+            candidates.emplace_back(entry.num_requests, &name);
+        }
+    }
+    std::size_t num_to_prefetch = std::min(num, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + num_to_prefetch, candidates.end(),
+                      [](const auto &a, const auto &b) { return a.first > b.first; });
+    for (std::size_t i = 0; i < num_to_prefetch; i++) {
+        prefetch_locked(*candidates[i].second);
+    }
+}
+
+void SoundCache::prefetch_loop() {
+    std::unique_lock lock(mutex);
+    while (true) {
+        prefetch_requested.wait(lock, [&]() { return stop_prefetching or not prefetch_queue.empty(); });
+        if (stop_prefetching) {
+            return;
+        }
+        std::string name = std::move(prefetch_queue.front());
+        prefetch_queue.pop_front();
+        load(lock, name_to_entry.at(name), name);
+    }
+}
+
+void SoundCache::set_memory_budget(std::size_t bytes) {
+    std::lock_guard lock(mutex);
+    memory_budget_bytes = bytes;
+    evict_until_within_budget();
+}
+
+std::size_t SoundCache::get_memory_budget() const {
+    std::lock_guard lock(mutex);
+    return memory_budget_bytes;
+}
+
+SoundCacheStats SoundCache::get_stats() const {
+    std::lock_guard lock(mutex);
+    return stats;
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,146 @@
+#ifndef SOUND_CACHE_HPP
+#define SOUND_CACHE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace tbx_engine {
+
+/// interleaved 16 bit pcm
+struct DecodedSound {
+    std::uint32_t sample_rate = 0;
+    std::uint16_t num_channels = 0;
+    std::vector<std::int16_t> samples;
+
+    std::size_t get_num_frames() const { return num_channels == 0 ? 0 : samples.size() / num_channels; }
+    std::size_t get_size_bytes() const { return samples.size() * sizeof(std::int16_t); }
+};
+
+/**
+ * @brief reads a wav file either all at once or a chunk at a time, converting every sample to 16 bit
+ *
+ * supports 8, 16, 24 and 32 bit integer pcm and 32 bit float, including the extensible variants of those
+ */
+class WavReader {
+  public:
+    bool open(const std::string &path);
+    bool is_open() const { return file.is_open(); }
+
+    /// @return the number of frames written to out, which is less than max_frames only at the end of the data
+    std::size_t read_frames(std::int16_t *out, std::size_t max_frames);
+    /// goes back to the first frame, eg to loop
+    bool rewind();
+
+    std::uint32_t get_sample_rate() const { return sample_rate; }
+    std::uint16_t get_num_channels() const { return num_channels; }
+    std::size_t get_num_frames() const { return num_frames; }
+
+  private:
+    std::ifstream file;
+    std::uint32_t sample_rate = 0;
+    std::uint16_t num_channels = 0;
+    std::uint16_t bits_per_sample = 0;
+    bool is_float = false;
+    std::streamoff data_offset = 0;
+    std::size_t num_frames = 0;
+    std::size_t num_frames_read = 0;
+    std::vector<char> raw_chunk;
+};
+
+std::optional<DecodedSound> decode_wav_file(const std::string &path);
+
+struct SoundCacheStats {
+    std::uint64_t num_hits = 0;
+    std::uint64_t num_misses = 0;
+    std::uint64_t num_evictions = 0;
+    std::uint64_t num_prefetches = 0;
+    std::uint64_t num_decode_failures = 0;
+    std::size_t resident_bytes = 0;
+    std::size_t num_resident_sounds = 0;
+};
+
+/**
+ * @brief decodes registered sounds the first time they are needed and keeps them under a memory budget
+ *
+ * registering a sound only remembers its path, get decodes it on a miss and keeps it, when the decoded sounds take more
+ * than memory_budget_bytes the least recently used ones are dropped, except those still held by someone, eg a voice
+ * that is playing them, so the budget can be exceeded for as long as everything resident is in use
+ *
+ * prefetch decodes on a background thread instead, so short effects that are about to be played are resident before
+ * they are needed, prefetch_most_used does that for the sounds that have been asked for most often
+ *
+ * @note thread safe
+ */
+class SoundCache {
+  public:
+    explicit SoundCache(std::size_t memory_budget_bytes = 64 << 20) : memory_budget_bytes(memory_budget_bytes) {}
+    ~SoundCache();
+
+    SoundCache(const SoundCache &) = delete;
+    SoundCache &operator=(const SoundCache &) = delete;
+
+    void register_sound(const std::string &name, const std::string &path);
+    bool is_registered(const std::string &name) const;
+
+    /// decodes on the calling thread on a miss, or waits if a prefetch of it is under way
+    /// @return nullptr if the sound isn't registered or couldn't be decoded
+    std::shared_ptr<const DecodedSound> get(const std::string &name);
+
+    /// starts decoding the sound on the background thread unless it's resident or already being loaded
+    void prefetch(const std::string &name);
+    /// prefetches the num sounds with the most calls to get that aren't resident
+    void prefetch_most_used(std::size_t num);
+
+    bool is_resident(const std::string &name) const;
+
+    /// evicts right away if the resident sounds no longer fit
+    void set_memory_budget(std::size_t bytes);
+    std::size_t get_memory_budget() const;
+
+    SoundCacheStats get_stats() const;
+
+  private:
+    struct Entry {
+        std::string path;
+        std::shared_ptr<const DecodedSound> sound;
+        std::list<std::string>::iterator lru_position;
+        std::uint64_t num_requests = 0;
+        bool is_loading = false;
+        /// set when the last attempt failed, such sounds are not prefetched again
+        bool decode_failed = false;
+    };
+
+    std::shared_ptr<const DecodedSound> load(std::unique_lock<std::mutex> &lock, Entry &entry, const std::string &name);
+    void make_most_recently_used(Entry &entry);
+    void evict_until_within_budget();
+    void prefetch_locked(const std::string &name);
+    void prefetch_loop();
+
+    mutable std::mutex mutex;
+    std::condition_variable loading_finished;
+    std::unordered_map<std::string, Entry> name_to_entry;
+    /// resident sounds, most recently used at the front
+    std::list<std::string> lru;
+    std::size_t memory_budget_bytes;
+    SoundCacheStats stats;
+
+    // NOTE: the prefetch thread is only started by the first prefetch, so a cache that never prefetches costs nothing
+    std::thread prefetch_thread;
+    std::condition_variable prefetch_requested;
+    std::deque<std::string> prefetch_queue;
+    bool stop_prefetching = false;
+};
+
+} // namespace tbx_engine
+
+#endif // SOUND_CACHE_HPP
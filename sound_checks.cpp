@@ -0,0 +1,168 @@
+#include "engine_checks.hpp"
+#include "sound_streaming.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace tbx_engine {
+
+namespace {
+
+float get_test_sample(std::size_t frame) { return 0.5f * std::sin(frame * 0.01f); }
+
+/// writes a sine wave, audio_format is 1 for integer pcm and 3 for float
+void write_test_wav(const std::string &path, std::uint32_t sample_rate, std::uint16_t num_channels,
+                    std::uint16_t bits_per_sample, std::uint16_t audio_format, std::uint32_t num_frames) {
+    std::ofstream file(path, std::ios::binary);
+    auto write_u32 = [&](std::uint32_t value) { file.write(reinterpret_cast<const char *>(&value), 4); };
+    auto write_u16 = [&](std::uint16_t value) { file.write(reinterpret_cast<const char *>(&value), 2); };
+
+    std::uint16_t bytes_per_sample = bits_per_sample / 8;
+    std::uint32_t data_size = num_frames * num_channels * bytes_per_sample;
+    file.write("RIFF", 4);
+    write_u32(36 + data_size);
+    file.write("WAVE", 4);
+    file.write("fmt ", 4);
+    write_u32(16);
+    write_u16(audio_format);
+    write_u16(num_channels);
+    write_u32(sample_rate);
+    write_u32(sample_rate * num_channels * bytes_per_sample);
+    write_u16(num_channels * bytes_per_sample);
+    write_u16(bits_per_sample);
+    file.write("data", 4);
+    write_u32(data_size);
+
+    for (std::uint32_t frame = 0; frame < num_frames; frame++) {
+        float sample = get_test_sample(frame);
+        for (std::uint16_t channel = 0; channel < num_channels; channel++) {
+            if (audio_format == 3) {
+                file.write(reinterpret_cast<const char *>(&sample), 4);
+            } else if (bits_per_sample == 8) {
+                auto value = static_cast<std::uint8_t>(128 + sample * 127);
+                file.write(reinterpret_cast<const char *>(&value), 1);
+            } else if (bits_per_sample == 16) {
+                auto value = static_cast<std::int16_t>(sample * 32767);
+                file.write(reinterpret_cast<const char *>(&value), 2);
+            } else {
+                // NOTE: little endian, the low three bytes of the 32 bit value
+                auto value = static_cast<std::int32_t>(sample * 8388607);
+                file.write(reinterpret_cast<const char *>(&value), 3);
+            }
+        }
+    }
+}
+
+/// waits up to a second for condition, which some background thread should make true
+template <typename Condition> bool wait_until(Condition &&condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (not condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<CheckResult> run_sound_checks() {
+    std::vector<CheckResult> results;
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "tbx_engine_sound_checks";
+    std::filesystem::create_directories(directory);
+    std::string stereo_16_bit = (directory / "stereo_16_bit.wav").string();
+    std::string mono_8_bit = (directory / "mono_8_bit.wav").string();
+    std::string stereo_float = (directory / "stereo_float.wav").string();
+    std::string mono_24_bit = (directory / "mono_24_bit.wav").string();
+    std::string music = (directory / "music.wav").string();
+    write_test_wav(stereo_16_bit, 48000, 2, 16, 1, 48000);
+    write_test_wav(mono_8_bit, 22050, 1, 8, 1, 22050);
+    write_test_wav(stereo_float, 44100, 2, 32, 3, 44100);
+    write_test_wav(mono_24_bit, 44100, 1, 24, 1, 44100);
+    write_test_wav(music, 8000, 2, 16, 1, 8000);
+
+    for (const std::string &path : {stereo_16_bit, mono_8_bit, stereo_float, mono_24_bit}) {
+        std::optional<DecodedSound> sound = decode_wav_file(path);
+        auto expected = static_cast<int>(get_test_sample(100) * 32767);
+        // NOTE: 8 bit only has 256 levels so it's compared loosely
+        bool matches = sound.has_value() and sound->get_num_frames() == sound->sample_rate and
+                       std::abs(sound->samples[100 * sound->num_channels] - expected) < 300;
+        results.push_back({"decodes " + std::filesystem::path(path).filename().string(), matches, ""});
+    }
+
+    // NOTE: the 16 bit stereo sound takes 192000 bytes and the float one 176400, so the two don't fit together
+    SoundCache cache(250'000);
+    cache.register_sound("stereo_16_bit", stereo_16_bit);
+    cache.register_sound("mono_8_bit", mono_8_bit);
+    cache.register_sound("stereo_float", stereo_float);
+    cache.register_sound("missing", (directory / "missing.wav").string());
+
+    bool decoded_on_first_get = not cache.is_resident("stereo_16_bit") and cache.get("stereo_16_bit") != nullptr and
+                                cache.is_resident("stereo_16_bit");
+    results.push_back({"a sound is decoded by the first get", decoded_on_first_get, ""});
+    {
+        std::shared_ptr<const DecodedSound> held_16_bit = cache.get("stereo_16_bit");
+        std::shared_ptr<const DecodedSound> held_float = cache.get("stereo_float");
+        SoundCacheStats stats = cache.get_stats();
+        results.push_back({"sounds in use are kept over budget", stats.num_resident_sounds == 2,
+                           std::to_string(stats.resident_bytes) + " bytes resident"});
+    }
+    cache.get("mono_8_bit");
+    SoundCacheStats stats = cache.get_stats();
+    results.push_back({"the least recently used sound is evicted",
+                       not cache.is_resident("stereo_16_bit") and stats.resident_bytes <= cache.get_memory_budget(),
+                       std::to_string(stats.num_evictions) + " evictions, " + std::to_string(stats.num_hits) +
+                           " hits, " + std::to_string(stats.num_misses) + " misses"});
+    results.push_back({"a missing file fails without throwing",
+                       cache.get("missing") == nullptr and cache.get_stats().num_decode_failures == 1, ""});
+
+    // NOTE: stereo_16_bit was asked for the most, so it is the one prefetch_most_used brings back
+    cache.get("stereo_16_bit");
+    cache.set_memory_budget(0);
+    cache.set_memory_budget(1 << 20);
+    cache.prefetch_most_used(1);
+    results.push_back({"prefetch_most_used decodes an evicted sound in the background",
+                       wait_until([&]() { return cache.is_resident("stereo_16_bit"); }),
+                       std::to_string(cache.get_stats().num_prefetches) + " prefetches"});
+
+    SoundStreamer streamer;
+    streamer.chunk_frames = 1024;
+    NullSoundOutputDevice device;
+    std::shared_ptr<SoundStream> music_stream = streamer.open_stream(music, false, 0.5);
+    std::shared_ptr<SoundStream> looping_stream = streamer.open_stream(mono_8_bit, true, 0.5);
+    if (music_stream == nullptr or looping_stream == nullptr) {
+        results.push_back({"open streams", false, "couldn't open the files"});
+        return results;
+    }
+    device.play(music_stream);
+    device.play(looping_stream);
+    device.play(cache.get("stereo_float"));
+    music_stream.reset();
+
+    // NOTE: the music and the float sound are a second long, so after a second and a half only the loop is left
+    const double dt = 1.0 / 60;
+    for (int i = 0; i < 90; i++) {
+        device.update(dt);
+        std::this_thread::sleep_for(std::chrono::duration<double>(dt));
+    }
+    results.push_back({"finished sounds and streams stop, loops keep going", device.get_num_playing() == 1,
+                       std::to_string(device.get_num_frames_played()) + " frames played, " +
+                           std::to_string(looping_stream->get_num_underruns()) + " underruns"});
+
+    looping_stream.reset();
+    device = NullSoundOutputDevice();
+    results.push_back({"a stream nobody holds is closed",
+                       wait_until([&]() { return streamer.get_num_open_streams() == 0; }), ""});
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return results;
+}
+
+} // namespace tbx_engine
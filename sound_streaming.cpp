@@ -0,0 +1,181 @@
+#include "sound_streaming.hpp"
+
+#include <algorithm>
+
+namespace tbx_engine {
+
+SoundStream::SoundStream(WavReader reader, bool loop, std::size_t capacity_frames, std::size_t chunk_frames)
+    : reader(std::move(reader)), loop(loop), sample_rate(this->reader.get_sample_rate()),
+      num_channels(this->reader.get_num_channels()), capacity_frames(std::max(capacity_frames, chunk_frames)),
+      chunk_frames(chunk_frames), ring(this->capacity_frames * num_channels) {}
+
+void SoundStream::refill() {
+    // NOTE: cleared before decoding so a read that drains the ring while this runs asks again instead of being lost
+    refill_pending.store(false, std::memory_order_relaxed);
+    if (reached_end.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::size_t write = write_frame.load(std::memory_order_relaxed);
+    while (true) {
+        std::size_t num_free_frames = capacity_frames - (write - read_frame.load(std::memory_order_acquire));
+        if (num_free_frames == 0) {
+            return;
+        }
+        // NOTE: only up to the end of the ring, the wrapped part is filled on the next pass of the loop
+        std::size_t ring_position = write % capacity_frames;
+        std::size_t num_frames_wanted = std::min({num_free_frames, capacity_frames - ring_position, chunk_frames});
+        std::size_t num_frames_got = reader.read_frames(ring.data() + ring_position * num_channels, num_frames_wanted);
+
+        if (num_frames_got == 0) {
+            // NOTE: an empty file would loop forever without ever producing anything
+            if (loop and reader.get_num_frames() > 0 and reader.rewind()) {
+                continue;
+            }
+            reached_end.store(true, std::memory_order_release);
+            return;
+        }
+        write += num_frames_got;
+        write_frame.store(write, std::memory_order_release);
+    }
+}
+
+std::size_t SoundStream::read_frames(std::int16_t *out, std::size_t max_frames) {
+    std::size_t read = read_frame.load(std::memory_order_relaxed);
+    // NOTE: reached_end is loaded before write_frame, if it is set every frame has already been published
+    bool at_end = reached_end.load(std::memory_order_acquire);
+    std::size_t num_available_frames = write_frame.load(std::memory_order_acquire) - read;
+    std::size_t num_frames = std::min(max_frames, num_available_frames);
+
+    std::size_t num_frames_copied = 0;
+    while (num_frames_copied < num_frames) {
+        std::size_t ring_position = (read + num_frames_copied) % capacity_frames;
+        std::size_t num_contiguous_frames = std::min(num_frames - num_frames_copied, capacity_frames - ring_position);
+        std::copy_n(ring.data() + ring_position * num_channels, num_contiguous_frames * num_channels,
+                    out + num_frames_copied * num_channels);
+        num_frames_copied += num_contiguous_frames;
+    }
+    read_frame.store(read + num_frames, std::memory_order_release);
+
+    if (num_frames < max_frames and not at_end) {
+        num_underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool ring_half_empty = num_available_frames - num_frames <= capacity_frames / 2;
+    if (ring_half_empty and not at_end and streamer_wakeup != nullptr and
+        not refill_pending.exchange(true, std::memory_order_relaxed)) {
+        streamer_wakeup->request_refill();
+    }
+    return num_frames;
+}
+
+SoundStreamer::~SoundStreamer() {
+    {
+        std::lock_guard lock(wakeup->mutex);
+        should_stop = true;
+    }
+    wakeup->condition.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+std::shared_ptr<SoundStream> SoundStreamer::open_stream(const std::string &path, bool loop, double buffer_s) {
+    WavReader reader;
+    if (not reader.open(path)) {
+        return nullptr;
+    }
+    std::size_t capacity_frames = static_cast<std::size_t>(buffer_s * reader.get_sample_rate());
+    auto stream = std::make_shared<SoundStream>(std::move(reader), loop, capacity_frames, chunk_frames);
+
+    // NOTE: one chunk is decoded here so there is something to play before the thread gets to it, the thread only
+    // sees the stream after this so the single writer rule of the ring holds
+    std::size_t first_chunk_frames =
+        stream->reader.read_frames(stream->ring.data(), std::min(chunk_frames, stream->capacity_frames));
+    stream->write_frame.store(first_chunk_frames, std::memory_order_release);
+    stream->streamer_wakeup = wakeup;
+
+    {
+        std::lock_guard lock(wakeup->mutex);
+        streams.push_back(stream);
+        // NOTE: the rest of the ring is filled right away rather than on the first read
+        wakeup->refill_requested = true;
+        if (not thread.joinable()) {
+            thread = std::thread([this]() { stream_loop(); });
+        }
+    }
+    wakeup->condition.notify_one();
+    return stream;
+}
+
+std::size_t SoundStreamer::get_num_open_streams() const {
+    std::lock_guard lock(wakeup->mutex);
+    return std::ranges::count_if(streams, [](const std::weak_ptr<SoundStream> &weak_stream) {
+        std::shared_ptr<SoundStream> stream = weak_stream.lock();
+        return stream != nullptr and not stream->is_finished();
+    });
+}
+
+void SoundStreamer::stream_loop() {
+    std::vector<std::shared_ptr<SoundStream>> streams_to_refill;
+    std::unique_lock lock(wakeup->mutex);
+    while (not should_stop) {
+        std::erase_if(streams, [&](const std::weak_ptr<SoundStream> &weak_stream) {
+            std::shared_ptr<SoundStream> stream = weak_stream.lock();
+            if (stream == nullptr or stream->is_finished()) {
+                return true;
+            }
+            streams_to_refill.push_back(std::move(stream));
+            return false;
+        });
+        wakeup->refill_requested = false;
+
+        // NOTE: decoding reads from disk so it happens unlocked, opening a stream never waits on it, a stream let go of
+        // meanwhile is destroyed here on this thread when its last reference is cleared
+        lock.unlock();
+        for (const std::shared_ptr<SoundStream> &stream : streams_to_refill) {
+            stream->refill();
+        }
+        streams_to_refill.clear();
+        lock.lock();
+
+        // NOTE: refilling every stream on any stream's request is fine, a stream whose ring is full returns right away
+        wakeup->condition.wait(lock, [&]() { return should_stop or wakeup->refill_requested; });
+    }
+}
+
+void NullSoundOutputDevice::play(std::shared_ptr<const DecodedSound> sound) {
+    if (sound != nullptr) {
+        playing_sounds.push_back({std::move(sound)});
+    }
+}
+
+void NullSoundOutputDevice::play(std::shared_ptr<SoundStream> stream) {
+    if (stream != nullptr) {
+        playing_streams.push_back({std::move(stream)});
+    }
+}
+
+void NullSoundOutputDevice::update(double dt) {
+    for (PlayingSound &playing : playing_sounds) {
+        double num_frames = dt * playing.sound->sample_rate + playing.frame_remainder;
+        auto num_whole_frames = static_cast<std::size_t>(num_frames);
+        playing.frame_remainder = num_frames - num_whole_frames;
+        std::size_t num_frames_left = playing.sound->get_num_frames() - playing.next_frame;
+        std::size_t num_frames_played_now = std::min(num_whole_frames, num_frames_left);
+        playing.next_frame += num_frames_played_now;
+        num_frames_played += num_frames_played_now;
+    }
+    std::erase_if(playing_sounds,
+                  [](const PlayingSound &playing) { return playing.next_frame == playing.sound->get_num_frames(); });
+
+    for (PlayingStream &playing : playing_streams) {
+        double num_frames = dt * playing.stream->get_sample_rate() + playing.frame_remainder;
+        auto num_whole_frames = static_cast<std::size_t>(num_frames);
+        playing.frame_remainder = num_frames - num_whole_frames;
+        mix_buffer.resize(num_whole_frames * playing.stream->get_num_channels());
+        num_frames_played += playing.stream->read_frames(mix_buffer.data(), num_whole_frames);
+    }
+    std::erase_if(playing_streams, [](const PlayingStream &playing) { return playing.stream->is_finished(); });
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,161 @@
+#ifndef SOUND_STREAMING_HPP
+#define SOUND_STREAMING_HPP
+
+#include "sound_cache.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tbx_engine {
+
+/// how streams wake their streamer's thread, shared with every stream so one that outlives its streamer stays valid
+struct SoundStreamerWakeup {
+    std::mutex mutex;
+    std::condition_variable condition;
+    /// guarded by mutex
+    bool refill_requested = false;
+
+    void request_refill() {
+        {
+            std::lock_guard lock(mutex);
+            refill_requested = true;
+        }
+        condition.notify_one();
+    }
+};
+
+/**
+ * @brief a long sound, eg music or an ambient loop, that is decoded a chunk at a time instead of all at once
+ *
+ * a SoundStreamer keeps a few seconds decoded ahead in a ring buffer from its own thread and whoever plays the stream
+ * reads from the other end, the two sides never lock the ring, if the reader catches up with the decoder that's an
+ * underrun, once a read leaves the ring half empty the streamer's thread is woken to top it up, which takes a lock once
+ * per half a buffer
+ *
+ */
+class SoundStream {
+  public:
+    SoundStream(WavReader reader, bool loop, std::size_t capacity_frames, std::size_t chunk_frames);
+
+    SoundStream(const SoundStream &) = delete;
+    SoundStream &operator=(const SoundStream &) = delete;
+
+    /// @return the number of frames written to out, less than max_frames when the buffer ran dry or the sound ended
+    std::size_t read_frames(std::int16_t *out, std::size_t max_frames);
+
+    /// true once every frame has been read and it isn't looping
+    bool is_finished() const {
+        return reached_end.load(std::memory_order_acquire) and
+               read_frame.load(std::memory_order_relaxed) == write_frame.load(std::memory_order_acquire);
+    }
+
+    std::uint32_t get_sample_rate() const { return sample_rate; }
+    std::uint16_t get_num_channels() const { return num_channels; }
+    std::size_t get_num_buffered_frames() const {
+        return write_frame.load(std::memory_order_acquire) - read_frame.load(std::memory_order_acquire);
+    }
+    /// how many reads came up short while the sound wasn't over yet
+    std::uint64_t get_num_underruns() const { return num_underruns.load(std::memory_order_relaxed); }
+
+  private:
+    friend class SoundStreamer;
+
+    /// decodes chunks until the ring buffer is full, only the streamer's thread calls this
+    void refill();
+
+    std::shared_ptr<SoundStreamerWakeup> streamer_wakeup;
+    /// set from the read that asked for a refill until the refill starts, so a reader asks only once
+    std::atomic<bool> refill_pending{false};
+
+    WavReader reader;
+    bool loop;
+    std::uint32_t sample_rate;
+    std::uint16_t num_channels;
+    std::size_t capacity_frames;
+    std::size_t chunk_frames;
+    std::vector<std::int16_t> ring;
+
+    alignas(64) std::atomic<std::size_t> write_frame{0};
+    alignas(64) std::atomic<std::size_t> read_frame{0};
+    std::atomic<bool> reached_end{false};
+    std::atomic<std::uint64_t> num_underruns{0};
+};
+
+/**
+ * @brief opens SoundStreams and keeps them topped up from a background thread
+ *
+ * a stream stays open for as long as someone other than the streamer holds it, the streamer only keeps weak references
+ * so letting go of one closes its file right away, the thread is only started by the first stream so it costs nothing
+ * if nothing is streamed, and it sleeps until a stream needs more data
+ *
+ */
+class SoundStreamer {
+  public:
+    SoundStreamer() = default;
+    ~SoundStreamer();
+
+    SoundStreamer(const SoundStreamer &) = delete;
+    SoundStreamer &operator=(const SoundStreamer &) = delete;
+
+    /// decodes the first chunk right away so the stream can be played immediately
+    /// @param buffer_s how far ahead of the reader the stream is kept decoded
+    /// @return nullptr if the file can't be read
+    std::shared_ptr<SoundStream> open_stream(const std::string &path, bool loop = false, double buffer_s = 2);
+
+    std::size_t get_num_open_streams() const;
+
+    std::size_t chunk_frames = 4096;
+
+  private:
+    void stream_loop();
+
+    // NOTE: the wakeup's mutex also guards should_stop and streams, so a stop or a new stream can't be missed between
+    // the thread checking for work and going to sleep
+    std::shared_ptr<SoundStreamerWakeup> wakeup = std::make_shared<SoundStreamerWakeup>();
+    bool should_stop = false;
+    std::vector<std::weak_ptr<SoundStream>> streams;
+    std::thread thread;
+};
+
+/**
+ * @brief plays sounds and streams into nothing, it consumes frames at the rate a real device would, so the cache and
+ * streaming can be exercised on a machine without audio hardware, eg in ci or on a headless server
+ */
+class NullSoundOutputDevice {
+  public:
+    void play(std::shared_ptr<const DecodedSound> sound);
+    void play(std::shared_ptr<SoundStream> stream);
+
+    /// consumes dt seconds of every playing sound and stream and drops the ones that finished
+    void update(double dt);
+
+    std::size_t get_num_playing() const { return playing_sounds.size() + playing_streams.size(); }
+    std::uint64_t get_num_frames_played() const { return num_frames_played; }
+
+  private:
+    struct PlayingSound {
+        std::shared_ptr<const DecodedSound> sound;
+        std::size_t next_frame = 0;
+        double frame_remainder = 0;
+    };
+
+    struct PlayingStream {
+        std::shared_ptr<SoundStream> stream;
+        double frame_remainder = 0;
+    };
+
+    std::vector<PlayingSound> playing_sounds;
+    std::vector<PlayingStream> playing_streams;
+    std::vector<std::int16_t> mix_buffer;
+    std::uint64_t num_frames_played = 0;
+};
+
+} // namespace tbx_engine
+
+#endif // SOUND_STREAMING_HPP
@@ -0,0 +1,68 @@
+#include "startup_report.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace tbx_engine {
+
+void StartupReport::begin_main_thread_stage(const std::string &name) {
+    Clock::time_point now = Clock::now();
+    end_main_thread_stage(now);
+    current_main_thread_stage = name;
+    current_main_thread_stage_start = now;
+}
+
+void StartupReport::finish() {
+    Clock::time_point now = Clock::now();
+    end_main_thread_stage(now);
+    total_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now - creation_time);
+}
+
+void StartupReport::end_main_thread_stage(Clock::time_point end) {
+    if (current_main_thread_stage.has_value()) {
+        record_stage(*current_main_thread_stage, current_main_thread_stage_start, end);
+        current_main_thread_stage = std::nullopt;
+    }
+}
+
+void StartupReport::record_stage(const std::string &name, Clock::time_point start, Clock::time_point end) {
+    StartupStageTiming timing{name, std::chrono::duration_cast<std::chrono::nanoseconds>(start - creation_time),
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(end - start),
+                              std::this_thread::get_id() == main_thread_id};
+    std::lock_guard<std::mutex> lock(stages_mutex);
+    stages.push_back(std::move(timing));
+}
+
+std::vector<StartupStageTiming> StartupReport::get_stages() const {
+    std::vector<StartupStageTiming> sorted_stages;
+    {
+        std::lock_guard<std::mutex> lock(stages_mutex);
+        sorted_stages = stages;
+    }
+    std::stable_sort(sorted_stages.begin(), sorted_stages.end(),
+                     [](const StartupStageTiming &a, const StartupStageTiming &b) { return a.start < b.start; });
+    return sorted_stages;
+}
+
+std::string StartupReport::to_string() const {
+    auto to_ms = [](std::chrono::nanoseconds duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "startup took " << to_ms(get_total_duration()) << "ms\n";
+
+    std::chrono::nanoseconds sum_of_stages{0};
+    for (const StartupStageTiming &stage : get_stages()) {
+        sum_of_stages += stage.duration;
+        out << "  " << std::setw(10) << to_ms(stage.start) << "ms  +" << std::setw(10) << to_ms(stage.duration)
+            << "ms  " << (stage.ran_on_main_thread ? "main  " : "worker") << "  " << stage.name << "\n";
+    }
+    // NOTE: when this is larger than the total some stages overlapped
+    out << "sum of all stages " << to_ms(sum_of_stages) << "ms";
+    return out.str();
+}
+
+} // namespace tbx_engine
@@ -0,0 +1,138 @@
+#ifndef STARTUP_REPORT_HPP
+#define STARTUP_REPORT_HPP
+
+#include "job_system.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tbx_engine {
+
+struct StartupStageTiming {
+    std::string name;
+    /// when the stage started, relative to when the report was created
+    std::chrono::nanoseconds start;
+    std::chrono::nanoseconds duration;
+    bool ran_on_main_thread;
+};
+
+/**
+ * @brief how long each stage of the engine's startup took and which thread it ran on
+ *
+ * main thread stages run back to back, each one ends when the next one begins, background stages can run on any thread
+ * and are recorded when they finish, stages can be recorded from any thread
+ *
+ */
+class StartupReport {
+  public:
+    StartupReport() : creation_time(Clock::now()), main_thread_id(std::this_thread::get_id()) {}
+
+    /// ends the main thread stage that is currently running, if any, and starts a new one
+    void begin_main_thread_stage(const std::string &name);
+    /// ends the main thread stage that is currently running and marks startup as done
+    void finish();
+
+    void record_stage(const std::string &name, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end);
+
+    bool is_finished() const { return total_duration.has_value(); }
+    /// @return the wall clock time from the creation of the report until finish was called
+    std::chrono::nanoseconds get_total_duration() const { return total_duration.value_or(std::chrono::nanoseconds(0)); }
+
+    /// @return every recorded stage ordered by when it started
+    std::vector<StartupStageTiming> get_stages() const;
+
+    /// a table of every stage with its start time, duration and thread, followed by the total
+    std::string to_string() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    void end_main_thread_stage(Clock::time_point end);
+
+    Clock::time_point creation_time;
+    std::thread::id main_thread_id;
+    std::optional<std::string> current_main_thread_stage;
+    Clock::time_point current_main_thread_stage_start;
+    std::optional<std::chrono::nanoseconds> total_duration;
+
+    mutable std::mutex stages_mutex;
+    std::vector<StartupStageTiming> stages;
+};
+
+/**
+ * @brief starts the next main thread stage when it is constructed
+ *
+ * the engine's startup is mostly the construction of its members, so declaring one of these in between two members
+ * is how the member initializations that follow it are timed as one stage
+ */
+class StartupStageMarker {
+  public:
+    StartupStageMarker(StartupReport &startup_report, const std::string &stage_name) {
+        startup_report.begin_main_thread_stage(stage_name);
+    }
+};
+
+/**
+ * @brief constructs a T on the job system while the main thread carries on with startup, used for the parts of
+ * startup which don't need the gl context
+ *
+ * @note if the construction throws the exception is rethrown from get
+ */
+template <typename T> class BackgroundStartupStage {
+  public:
+    template <typename MakeFunc>
+    BackgroundStartupStage(JobSystem &job_system, StartupReport &startup_report, const std::string &stage_name,
+                           MakeFunc make)
+        : job_system(job_system) {
+        job_system.submit(
+            [this, &startup_report, stage_name, make = std::move(make)]() {
+                auto start = std::chrono::steady_clock::now();
+                result = make();
+                startup_report.record_stage(stage_name, start, std::chrono::steady_clock::now());
+            },
+            &job_group);
+    }
+
+    // NOTE: if the owner's constructor throws before get was called the job is still referring to us, so we have to
+    // wait for it here
+    ~BackgroundStartupStage() {
+        try {
+            job_system.wait(job_group);
+        } catch (...) {
+        }
+    }
+
+    BackgroundStartupStage(const BackgroundStartupStage &) = delete;
+    BackgroundStartupStage &operator=(const BackgroundStartupStage &) = delete;
+
+    /// waits for the construction to finish, the calling thread helps run jobs in the meantime
+    T &get() {
+        job_system.wait(job_group);
+        return *result;
+    }
+
+  private:
+    JobSystem &job_system;
+    JobGroup job_group;
+    std::unique_ptr<T> result;
+};
+
+/// starts a main thread stage that lasts until a background stage is done, so time spent waiting on it is reported
+template <typename T> class BackgroundStartupStageWait : public StartupStageMarker {
+  public:
+    BackgroundStartupStageWait(StartupReport &startup_report, const std::string &stage_name,
+                               BackgroundStartupStage<T> &background_stage)
+        : StartupStageMarker(startup_report, stage_name) {
+        background_stage.get();
+    }
+};
+
+} // namespace tbx_engine
+
+#endif // STARTUP_REPORT_HPP
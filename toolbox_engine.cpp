@@ -22,29 +22,143 @@ EKey get_input_key_from_config_or_default_value(InputState &input_state, Configu
     return opt_val.value_or(movement_value_str_to_default_key.at(section_key));
 }
 
-void register_input_graphics_sound_config_handlers(Configuration &configuration, FPSCamera &fps_camera,
-                                                   FixedFrequencyLoop &ffl) {
+ActionBindings::ActionBindings() {
+    for (std::size_t i = 0; i < num_movement_actions; i++) {
+        action_to_key[i] = movement_value_str_to_default_key.at(movement_action_to_config_value[i]);
+    }
+}
 
-    configuration.register_config_handler("input", "mouse_sensitivity", [&](const std::string value) {
-        float requested_sens;
-        try {
-            requested_sens = std::stof(value);
-            fps_camera.change_active_sensitivity(requested_sens);
-        } catch (const std::exception &) {
-            std::cout << "sensivity is invalid" << std::endl;
+// NOTE: the registration functions are written once against anything with a register_config_handler(section, key,
+// handler) member, so they work both on a Configuration and on a ConfigHandlerRegistry
+
+template <typename ConfigHandlerTarget>
+static void register_action_binding_config_handlers(ConfigHandlerTarget &config_handler_target,
+                                                    std::array<EKey, num_movement_actions> &action_to_key,
+                                                    InputState &input_state) {
+    for (std::size_t i = 0; i < num_movement_actions; i++) {
+        const std::string &config_value = movement_action_to_config_value[i];
+        config_handler_target.register_config_handler("input", config_value, [&, i](const std::string value) {
+            if (input_state.is_valid_key_string(value)) {
+                action_to_key[i] = input_state.key_str_to_key_enum.at(value);
+            } else {
+                action_to_key[i] = movement_value_str_to_default_key.at(movement_action_to_config_value[i]);
+            }
+        });
+    }
+}
+
+void ActionBindings::register_config_handlers(Configuration &configuration, InputState &input_state) {
+    register_action_binding_config_handlers(configuration, action_to_key, input_state);
+}
+
+void ActionBindings::register_config_handlers(ConfigHandlerRegistry &config_handlers, InputState &input_state) {
+    register_action_binding_config_handlers(config_handlers, action_to_key, input_state);
+}
+
+ActionBindings::ActionSet ActionBindings::get_pressed_actions(InputState &input_state) const {
+    ActionSet pressed;
+    for (std::size_t i = 0; i < num_movement_actions; i++) {
+        pressed[i] = input_state.is_pressed(action_to_key[i]);
+    }
+    return pressed;
+}
+
+movement::GodModeInput ActionBindings::get_god_mode_movement_input(InputState &input_state) const {
+    auto pressed = get_pressed_actions(input_state);
+    return {is_set(pressed, MovementAction::slow_move), is_set(pressed, MovementAction::fast_move),
+            is_set(pressed, MovementAction::forward),   is_set(pressed, MovementAction::left),
+            is_set(pressed, MovementAction::back),      is_set(pressed, MovementAction::right),
+            is_set(pressed, MovementAction::up),        is_set(pressed, MovementAction::down)};
+}
+
+movement::FPSModeInput ActionBindings::get_fps_mode_movement_input(InputState &input_state) const {
+    auto pressed = get_pressed_actions(input_state);
+    return {is_set(pressed, MovementAction::forward), is_set(pressed, MovementAction::back),
+            is_set(pressed, MovementAction::right), is_set(pressed, MovementAction::left),
+            is_set(pressed, MovementAction::jump)};
+}
+
+std::size_t TextGeometryCache::GlyphKeyHash::operator()(const GlyphKey &key) const {
+    std::size_t seed = std::hash<char>()(key.character);
+    for (float component : {key.center_x, key.center_y, key.center_z, key.width, key.height}) {
+        seed ^= std::hash<float>()(component) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+draw_info::IndexedVertexPositions
+TextGeometryCache::get_text_geometry(std::string_view text, const vertex_geometry::Rectangle &bounding_rect) {
+    if (glyph_key_to_geometry.size() > max_cached_glyphs) {
+        glyph_key_to_geometry.clear();
+    }
+
+    std::vector<unsigned int> indices;
+    std::vector<glm::vec3> xyz_positions;
+
+    if (text.empty()) {
+        return {indices, xyz_positions};
+    }
+
+    float cell_width = bounding_rect.width / text.size();
+    float left_x = bounding_rect.center.x - bounding_rect.width / 2;
+
+    for (std::size_t i = 0; i < text.size(); i++) {
+        glm::vec3 cell_center(left_x + (i + 0.5f) * cell_width, bounding_rect.center.y, bounding_rect.center.z);
+        GlyphKey key{text[i], cell_center.x, cell_center.y, cell_center.z, cell_width, bounding_rect.height};
+
+        auto it = glyph_key_to_geometry.find(key);
+        if (it == glyph_key_to_geometry.end()) {
+            vertex_geometry::Rectangle cell(cell_center, cell_width, bounding_rect.height);
+            auto glyph_geometry = grid_font::get_text_geometry(std::string(1, text[i]), cell);
+            it = glyph_key_to_geometry.emplace(key, glyph_geometry).first;
         }
-    });
 
-    configuration.register_config_handler("graphics", "field_of_view", [&](const std::string value) {
-        float fov, default_fov = 90;
-        try {
-            fov = std::stof(value);
-            fps_camera.fov = fov;
-        } catch (const std::exception &) {
-            std::cout << "fov is invalid" << std::endl;
+        const draw_info::IndexedVertexPositions &glyph = it->second;
+        unsigned int index_offset = xyz_positions.size();
+        for (unsigned int index : glyph.indices) {
+            indices.push_back(index + index_offset);
         }
-    });
+        xyz_positions.insert(xyz_positions.end(), glyph.xyz_positions.begin(), glyph.xyz_positions.end());
+    }
 
+    return {indices, xyz_positions};
+}
+
+bool HUDTextLine::update(std::string_view text, const vertex_geometry::Rectangle &bounding_rect,
+                         const glm::vec3 &color, TextGeometryCache &text_geometry_cache) {
+    bool rect_unchanged = bounding_rect.center == current_bounding_rect.center and
+                          bounding_rect.width == current_bounding_rect.width and
+                          bounding_rect.height == current_bounding_rect.height;
+
+    if (has_geometry and text == current_text and rect_unchanged and color == current_color) {
+        return false;
+    }
+
+    // NOTE: here the copy assignment function is used, thus ids are not clobbered, but object becomes dirty,
+    // which is what we want.
+    ivpc.copy_draw_data_from(draw_info::IVPColor(text_geometry_cache.get_text_geometry(text, bounding_rect), color));
+
+    has_geometry = true;
+    current_text = text;
+    current_bounding_rect = bounding_rect;
+    current_color = color;
+    return true;
+}
+
+/// puts the main loop into the mode that matches the pacer, when the pacer is doing the waiting the loop itself must
+/// not wait as well
+void configure_main_loop_pacing(FixedFrequencyLoop &ffl, const FramePacer &frame_pacer) {
+    std::optional<double> target_rate_hz = frame_pacer.get_target_rate_hz();
+    if (not target_rate_hz.has_value() or frame_pacer.is_pacing()) {
+        ffl.set_operation_mode(FixedFrequencyLoop::OperationMode::as_fast_as_possible);
+    } else {
+        ffl.rate_limiter_enabled = true;
+        ffl.set_operation_mode(FixedFrequencyLoop::OperationMode::fixed_frequency);
+        ffl.set_max_update_rate_hz(*target_rate_hz);
+    }
+}
+
+void register_main_loop_config_handlers(Configuration &configuration, FixedFrequencyLoop &ffl) {
     configuration.register_config_handler("graphics", "max_fps", [&](const std::string value) {
         int max_fps;
         try {
@@ -62,6 +176,97 @@ void register_input_graphics_sound_config_handlers(Configuration &configuration,
     });
 }
 
+template <typename ConfigHandlerTarget>
+static void register_paced_main_loop_config_handlers(ConfigHandlerTarget &config_handler_target,
+                                                     FixedFrequencyLoop &ffl, FramePacer &frame_pacer) {
+    config_handler_target.register_config_handler("graphics", "max_fps", [&](const std::string value) {
+        int max_fps;
+        try {
+            max_fps = std::stoi(value);
+            frame_pacer.set_target_rate_hz(max_fps);
+        } catch (const std::exception &) {
+            if (value == "inf") {
+                frame_pacer.set_target_rate_hz(std::nullopt);
+            } else {
+                std::cout << "max fps value couldn't be converted to an integer." << std::endl;
+                return;
+            }
+        }
+        configure_main_loop_pacing(ffl, frame_pacer);
+    });
+
+    config_handler_target.register_config_handler("graphics", "wait_strategy", [&](const std::string value) {
+        auto strategy = parse_frame_pacing_strategy(value);
+        if (strategy.has_value()) {
+            frame_pacer.strategy = *strategy;
+            frame_pacer.reset_deadline();
+            configure_main_loop_pacing(ffl, frame_pacer);
+        } else {
+            std::cout << "wait strategy must be one of busy_wait, sleep or hybrid." << std::endl;
+        }
+    });
+}
+
+void register_main_loop_config_handlers(Configuration &configuration, FixedFrequencyLoop &ffl,
+                                        FramePacer &frame_pacer) {
+    register_paced_main_loop_config_handlers(configuration, ffl, frame_pacer);
+}
+
+void register_main_loop_config_handlers(ConfigHandlerRegistry &config_handlers, FixedFrequencyLoop &ffl,
+                                        FramePacer &frame_pacer) {
+    register_paced_main_loop_config_handlers(config_handlers, ffl, frame_pacer);
+}
+
+template <typename ConfigHandlerTarget>
+static void register_camera_config_handlers_impl(ConfigHandlerTarget &config_handler_target, FPSCamera &fps_camera) {
+
+    config_handler_target.register_config_handler("input", "mouse_sensitivity", [&](const std::string value) {
+        float requested_sens;
+        try {
+            requested_sens = std::stof(value);
+            fps_camera.change_active_sensitivity(requested_sens);
+        } catch (const std::exception &) {
+            std::cout << "sensivity is invalid" << std::endl;
+        }
+    });
+
+    config_handler_target.register_config_handler("graphics", "field_of_view", [&](const std::string value) {
+        float fov, default_fov = 90;
+        try {
+            fov = std::stof(value);
+            fps_camera.fov = fov;
+        } catch (const std::exception &) {
+            std::cout << "fov is invalid" << std::endl;
+        }
+    });
+}
+
+void register_camera_config_handlers(Configuration &configuration, FPSCamera &fps_camera) {
+    register_camera_config_handlers_impl(configuration, fps_camera);
+}
+
+void register_camera_config_handlers(ConfigHandlerRegistry &config_handlers, FPSCamera &fps_camera) {
+    register_camera_config_handlers_impl(config_handlers, fps_camera);
+}
+
+void register_input_graphics_sound_config_handlers(Configuration &configuration, FPSCamera &fps_camera,
+                                                   FixedFrequencyLoop &ffl) {
+    register_camera_config_handlers(configuration, fps_camera);
+    register_main_loop_config_handlers(configuration, ffl);
+}
+
+void register_input_graphics_sound_config_handlers(Configuration &configuration, FPSCamera &fps_camera,
+                                                   FixedFrequencyLoop &ffl, FramePacer &frame_pacer) {
+    register_camera_config_handlers(configuration, fps_camera);
+    register_main_loop_config_handlers(configuration, ffl, frame_pacer);
+}
+
+void register_input_graphics_sound_config_handlers(ConfigHandlerRegistry &config_handlers, FPSCamera &fps_camera,
+                                                   FixedFrequencyLoop &ffl, FramePacer &frame_pacer) {
+    register_camera_config_handlers(config_handlers, fps_camera);
+    register_main_loop_config_handlers(config_handlers, ffl, frame_pacer);
+}
+
 void potentially_switch_between_menu_and_3d_view(InputState &input_state,
                                                  InputGraphicsSoundMenu &input_graphics_sound_menu,
                                                  FPSCamera &fps_camera, Window &window) {
@@ -81,16 +286,56 @@ void potentially_switch_between_menu_and_3d_view(InputState &input_state,
 /// glfw_callback_manager
 AllGLFWLambdaCallbacks create_default_glcm_for_input_and_camera(GLFWInputAdapter &glfw_input_adapter,
                                                                 FPSCamera &fps_camera, Window &window,
-                                                                ShaderCache &shader_cache) {
+                                                                ShaderCache &shader_cache,
+                                                                InputRecorder *input_recorder,
+                                                                const InputReplay *input_replay,
+                                                                InputEventQueue *input_event_queue) {
+    auto replay_active = [input_replay]() { return input_replay != nullptr and input_replay->is_active(); };
+    auto recording = [input_recorder]() { return input_recorder != nullptr and input_recorder->is_recording(); };
+
     std::function<void(unsigned int)> char_callback = [](unsigned int codepoint) {};
-    std::function<void(int, int, int, int)> key_callback = [&](int key, int scancode, int action, int mods) {
+    std::function<void(int, int, int, int)> key_callback = [&, replay_active, recording, input_recorder,
+                                                            input_event_queue](int key, int scancode, int action,
+                                                                               int mods) {
+        if (replay_active()) {
+            return;
+        }
+        if (input_event_queue != nullptr) {
+            input_event_queue->push_key(key, scancode, action, mods);
+            return;
+        }
+        if (recording()) {
+            input_recorder->record_key(key, scancode, action, mods);
+        }
         glfw_input_adapter.glfw_key_callback(key, scancode, action, mods);
     };
-    std::function<void(double, double)> mouse_pos_callback = [&](double xpos, double ypos) {
+    std::function<void(double, double)> mouse_pos_callback = [&, replay_active, recording, input_recorder,
+                                                              input_event_queue](double xpos, double ypos) {
+        if (replay_active()) {
+            return;
+        }
+        if (input_event_queue != nullptr) {
+            input_event_queue->push_cursor_pos(xpos, ypos);
+            return;
+        }
+        if (recording()) {
+            input_recorder->record_cursor_pos(xpos, ypos);
+        }
         fps_camera.mouse_callback(xpos, ypos);
         glfw_input_adapter.glfw_cursor_pos_callback(xpos, ypos);
     };
-    std::function<void(int, int, int)> mouse_button_callback = [&](int button, int action, int mods) {
+    std::function<void(int, int, int)> mouse_button_callback = [&, replay_active, recording, input_recorder,
+                                                               input_event_queue](int button, int action, int mods) {
+        if (replay_active()) {
+            return;
+        }
+        if (input_event_queue != nullptr) {
+            input_event_queue->push_mouse_button(button, action, mods);
+            return;
+        }
+        if (recording()) {
+            input_recorder->record_mouse_button(button, action, mods);
+        }
         glfw_input_adapter.glfw_mouse_button_callback(button, action, mods);
     };
 
@@ -156,4 +401,45 @@ int parse_int_or_default(const std::string &text, int default_value) {
     }
 }
 
+ArenaString vec3_to_arena_string(FrameArena &arena, const glm::vec3 &vec, int decimal_places) {
+    ArenaString text = make_arena_string(arena);
+    text.reserve(64);
+    text += "(";
+    text += to_arena_string(arena, vec.x, decimal_places);
+    text += ", ";
+    text += to_arena_string(arena, vec.y, decimal_places);
+    text += ", ";
+    text += to_arena_string(arena, vec.z, decimal_places);
+    text += ")";
+    return text;
+}
+
+vertex_geometry::Rectangle EngineStatsHUD::get_line_rect(const glm::vec3 &top_right, int line_index) {
+    float side_length = 0.2;
+    return vertex_geometry::slide_rectangle(
+        vertex_geometry::create_rectangle_from_top_right(top_right, side_length, side_length), 0, -line_index);
+}
+
+const draw_info::IVPColor &EngineStatsHUD::update_fps_text(FrameArena &arena, int average_fps,
+                                                           const glm::vec3 &top_right) {
+    // NOTE: the geometry is only rebuilt when the text or its placement changed, otherwise the ivpc stays clean
+    fps_text.update(to_arena_string(arena, static_cast<long long>(average_fps)), get_line_rect(top_right, 0),
+                    colors::grey, text_geometry_cache);
+    return fps_text.ivpc;
+}
+
+const draw_info::IVPColor &EngineStatsHUD::update_iteration_count_text(FrameArena &arena, long long iteration_count,
+                                                                       const glm::vec3 &top_right) {
+    iteration_count_text.update(to_arena_string(arena, iteration_count), get_line_rect(top_right, 1), colors::grey,
+                                text_geometry_cache);
+    return iteration_count_text.ivpc;
+}
+
+const draw_info::IVPColor &EngineStatsHUD::update_pos_text(FrameArena &arena, const glm::vec3 &pos,
+                                                           const glm::vec3 &top_right) {
+    pos_text.update(vec3_to_arena_string(arena, pos, 2), get_line_rect(top_right, 2), colors::grey,
+                    text_geometry_cache);
+    return pos_text.ivpc;
+}
+
 } // namespace tbx_engine
@@ -2,10 +2,34 @@
 #define TOOLBOX_ENGINE_HPP
 
 #include "sbpt_generated_includes.hpp"
+#include "allocation_counter.hpp"
+#include "async_logger.hpp"
+#include "config_handles.hpp"
+#include "config_hot_reload.hpp"
+#include "fixed_timestep.hpp"
+#include "frame_arena.hpp"
+#include "frame_pacer.hpp"
+#include "frame_rate_governor.hpp"
+#include "frame_profiler.hpp"
+#include "frame_telemetry.hpp"
+#include "frustum_culling.hpp"
+#include "input_event_queue.hpp"
+#include "input_recording.hpp"
+#include "job_system.hpp"
+#include "replication.hpp"
+#include "startup_report.hpp"
+#include "triple_buffer.hpp"
 
 #include <GLFW/glfw3.h>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <exception>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <thread>
+#include <tuple>
 #include <utility>
 
 namespace tbx_engine {
@@ -31,368 +55,661 @@ const std::unordered_map<std::string, EKey> movement_value_str_to_default_key =
     {config_value_jump, EKey::SPACE},
     {config_value_down, EKey::LEFT_SHIFT}};
 
+enum class MovementAction { slow_move, fast_move, forward, left, back, right, up, jump, down, count };
+
+constexpr std::size_t num_movement_actions = static_cast<std::size_t>(MovementAction::count);
+
+/// the [input] key that each movement action is bound by, indexed by MovementAction
+const std::array<std::string, num_movement_actions> movement_action_to_config_value = {
+    config_value_slow_move, config_value_fast_move, config_value_forward, config_value_left, config_value_back,
+    config_value_right,     config_value_up,        config_value_jump,    config_value_down};
+
+/**
+ * @brief the movement key bindings resolved once into a dense action to key table
+ *
+ * the table is rebuilt through config handlers whenever a binding in the [input] section is applied, so reading the
+ * pressed state of every action is a handful of array lookups instead of string lookups in the configuration
+ *
+ */
+class ActionBindings {
+  public:
+    using ActionSet = std::bitset<num_movement_actions>;
+
+    /// starts out with the bindings from movement_value_str_to_default_key
+    ActionBindings();
+
+    void register_config_handlers(Configuration &configuration, InputState &input_state);
+    void register_config_handlers(ConfigHandlerRegistry &config_handlers, InputState &input_state);
+
+    void bind(MovementAction action, EKey key) { action_to_key[static_cast<std::size_t>(action)] = key; }
+    EKey get_key(MovementAction action) const { return action_to_key[static_cast<std::size_t>(action)]; }
+
+    /// @return the set of actions whose bound key is currently pressed, indexed by MovementAction
+    ActionSet get_pressed_actions(InputState &input_state) const;
+
+    static bool is_set(const ActionSet &actions, MovementAction action) {
+        return actions.test(static_cast<std::size_t>(action));
+    }
+
+    movement::GodModeInput get_god_mode_movement_input(InputState &input_state) const;
+    movement::FPSModeInput get_fps_mode_movement_input(InputState &input_state) const;
+
+  private:
+    std::array<EKey, num_movement_actions> action_to_key;
+};
+
+/**
+ * @brief a copy of everything the simulation thread is allowed to know about input and the camera, taken on the main
+ * thread once per rendered frame
+ *
+ * presses are counted rather than flagged so that a press can't be lost or seen twice when the two threads run at
+ * different rates
+ */
+struct InputSnapshot {
+    ActionBindings::ActionSet pressed_actions;
+    std::array<std::uint32_t, num_movement_actions> action_press_counts{};
+    double mouse_position_x = 0, mouse_position_y = 0;
+    decltype(FPSCamera::transform) camera_transform;
+    std::uint64_t frame_index = 0;
+};
+
+/// the input as seen by one simulation tick
+class SimulationInput {
+  public:
+    InputSnapshot snapshot;
+    ActionBindings::ActionSet just_pressed_actions;
+
+    /// takes in the newest snapshot, actions whose press count went up since the last one are just pressed
+    void update(const InputSnapshot &new_snapshot) {
+        for (std::size_t i = 0; i < num_movement_actions; i++) {
+            just_pressed_actions[i] = new_snapshot.action_press_counts[i] != snapshot.action_press_counts[i];
+        }
+        snapshot = new_snapshot;
+    }
+
+    bool is_pressed(MovementAction action) const {
+        return ActionBindings::is_set(snapshot.pressed_actions, action);
+    }
+    bool is_just_pressed(MovementAction action) const { return ActionBindings::is_set(just_pressed_actions, action); }
+};
+
 std::optional<EKey> get_input_key_from_config_if_valid(InputState &input_state, Configuration &configuration,
                                                        const std::string &section_key);
 
 EKey get_input_key_from_config_or_default_value(InputState &input_state, Configuration &configuration,
                                                 const std::string &section_key);
 
+void configure_main_loop_pacing(FixedFrequencyLoop &ffl, const FramePacer &frame_pacer);
+
+// NOTE: handlers registered through the Configuration & overloads below go straight to the configuration, the
+// ConfigHandlerRegistry never sees them so the config hot reloader can't re-apply them, the engine itself always uses
+// the ConfigHandlerRegistry & ones
+
+/// registers max_fps so that the loop always rate limits by busy waiting, this is how the engine used to behave
+void register_main_loop_config_handlers(Configuration &configuration, FixedFrequencyLoop &ffl);
+
+/// registers max_fps and wait_strategy, the rate limiting is split between the loop and the frame pacer depending on
+/// the chosen strategy
+void register_main_loop_config_handlers(Configuration &configuration, FixedFrequencyLoop &ffl,
+                                        FramePacer &frame_pacer);
+void register_main_loop_config_handlers(ConfigHandlerRegistry &config_handlers, FixedFrequencyLoop &ffl,
+                                        FramePacer &frame_pacer);
+
+void register_camera_config_handlers(Configuration &configuration, FPSCamera &fps_camera);
+void register_camera_config_handlers(ConfigHandlerRegistry &config_handlers, FPSCamera &fps_camera);
+
 void register_input_graphics_sound_config_handlers(Configuration &configuration, FPSCamera &fps_camera,
                                                    FixedFrequencyLoop &ffl);
 
+void register_input_graphics_sound_config_handlers(Configuration &configuration, FPSCamera &fps_camera,
+                                                   FixedFrequencyLoop &ffl, FramePacer &frame_pacer);
+void register_input_graphics_sound_config_handlers(ConfigHandlerRegistry &config_handlers, FPSCamera &fps_camera,
+                                                   FixedFrequencyLoop &ffl, FramePacer &frame_pacer);
+
 void potentially_switch_between_menu_and_3d_view(InputState &input_state,
                                                  InputGraphicsSoundMenu &input_graphics_sound_menu,
                                                  FPSCamera &fps_camera, Window &window);
 
+/// @param input_recorder if given, every input event is also written to it while it is recording
+/// @param input_replay if given, live input events are ignored while it is active so they don't mix with the replay
+/// @param input_event_queue if given, key, button and cursor events are only pushed into it instead of being applied
+/// to the input state and camera right away, whoever drains it is then in charge of applying and recording them
 AllGLFWLambdaCallbacks create_default_glcm_for_input_and_camera(GLFWInputAdapter &glfw_input_adapter,
                                                                 FPSCamera &fps_camera, Window &window,
-                                                                ShaderCache &shader_cache);
+                                                                ShaderCache &shader_cache,
+                                                                InputRecorder *input_recorder = nullptr,
+                                                                const InputReplay *input_replay = nullptr,
+                                                                InputEventQueue *input_event_queue = nullptr);
 
 std::optional<std::pair<int, int>> extract_width_height_from_resolution(const std::string &resolution);
 
-const std::vector<std::string> on_off_options = {"on", "off"};
+/**
+ * @brief caches the geometry of single glyphs keyed by the character and the cell rectangle it is drawn into
+ *
+ * text is laid out the same way grid_font does it, one equally sized cell per character from left to right across the
+ * bounding rectangle, so once every glyph of a string has been seen, building the string's geometry is only copying
+ * cached vertices and offsetting indices
+ *
+ */
+class TextGeometryCache {
+  public:
+    /// when the cache grows past this many glyphs it is cleared, this bounds memory if text moves around a lot
+    std::size_t max_cached_glyphs = 4096;
 
-// NOTE: I don't think the following have to be lambdas.
+    draw_info::IndexedVertexPositions get_text_geometry(std::string_view text,
+                                                        const vertex_geometry::Rectangle &bounding_rect);
 
-bool parse_on_off_to_bool(const std::string &user_option);
-bool get_user_on_off_value_or_default(Configuration &configuration, const std::string &section_name,
-                                      const std::string &key_name);
-int parse_int_or_default(const std::string &text, int default_value);
+    std::size_t size() const { return glyph_key_to_geometry.size(); }
+    void clear() { glyph_key_to_geometry.clear(); }
 
-}; // namespace tbx_engine
+  private:
+    struct GlyphKey {
+        char character;
+        float center_x, center_y, center_z, width, height;
+        bool operator==(const GlyphKey &other) const {
+            return std::tie(character, center_x, center_y, center_z, width, height) ==
+                   std::tie(other.character, other.center_x, other.center_y, other.center_z, other.width,
+                            other.height);
+        }
+    };
+
+    struct GlyphKeyHash {
+        std::size_t operator()(const GlyphKey &key) const;
+    };
 
-// class ToolboxEngineCore {
-//     Logger console_logger;
-//     Configuration configuration;
-// };
+    std::unordered_map<GlyphKey, draw_info::IndexedVertexPositions, GlyphKeyHash> glyph_key_to_geometry;
+};
 
 /**
- * @pre you have to have generated the batcher for the absolute_position_with_colored_vertex shader, this is probably
- * the simplest shader that allows you to express objects with color so I don't find this to be a huge dependency
- *
- * This is a 3d interactive experience that has a 3d component and a 2d menu component
+ * @brief a single line of hud text which only regenerates its geometry when what it displays changes
  *
+ * @note when nothing changed the ivpc is left untouched so it stays clean and the batcher doesn't re-upload it
  */
-class ToolboxEngine {
-  private:
-    const std::string default_config_file_path = "assets/config/user_cfg.ini";
-    std::string wh;
-    const std::pair<int, int> default_resolution = {1280, 720};
-
+class HUDTextLine {
   public:
-    Configuration configuration;
+    draw_info::IVPColor ivpc;
 
-    bool window_should_close() { return glfwWindowShouldClose(window.glfw_window); }
+    /// @param text may live in the frame arena, it is only copied when it changed
+    /// @return true if the geometry was regenerated, in which case ivpc has been marked dirty
+    bool update(std::string_view text, const vertex_geometry::Rectangle &bounding_rect, const glm::vec3 &color,
+                TextGeometryCache &text_geometry_cache);
 
-    /// a wrapper around the main loop start function so we can inject engine specfic logic around what the user wants
-    /// to do.
-    void start(const std::function<void(double)> &rate_limited_func,
-               const std::optional<std::function<bool()>> &termination_condition_func = std::nullopt,
-               std::optional<std::function<void(IterationStats)>> loop_stats_function = std::nullopt) {
-        main_loop.wait_strategy = FixedFrequencyLoop::WaitStrategy::busy_wait;
-
-        std::function<bool()> term = termination_condition_func.value_or([&]() { return window_should_close(); });
+  private:
+    bool has_geometry = false;
+    std::string current_text;
+    vertex_geometry::Rectangle current_bounding_rect;
+    glm::vec3 current_color;
+};
 
-        main_loop.start(
+const std::vector<std::string> on_off_options = {"on", "off"};
 
-            [&](double dt) {
-                window.start_of_tick_glfw_logic();
-                rate_limited_func(dt);
-                window.end_of_tick_glfw_logic();
-                input_state.process();
-            },
+// NOTE: I don't think the following have to be lambdas.
 
-            term, loop_stats_function);
-    };
+bool parse_on_off_to_bool(const std::string &user_option);
+bool get_user_on_off_value_or_default(Configuration &configuration, const std::string &section_name,
+                                      const std::string &key_name);
+int parse_int_or_default(const std::string &text, int default_value);
 
-    std::pair<int, int> requested_resolution;
+/// formats as (x, y, z) into the arena, for text that is drawn every tick
+ArenaString vec3_to_arena_string(FrameArena &arena, const glm::vec3 &vec, int decimal_places);
 
-    Logger logger{"toolbox_engine"};
-    Window window;
+/**
+ * @brief the fps, iteration count and position lines that draw_chosen_engine_stats stacks down from the top right
+ *
+ * each update builds that line's text in the frame arena and returns the ivpc to queue, it doesn't touch the batcher so
+ * the benchmarks run exactly what draw_fps and draw_pos run, minus the queue_draw
+ */
+class EngineStatsHUD {
+  public:
+    TextGeometryCache text_geometry_cache;
+    HUDTextLine fps_text;
+    HUDTextLine iteration_count_text;
+    HUDTextLine pos_text;
 
-    GLFWLambdaCallbackManager glfw_lambda_callback_manager;
-    InputState input_state;
-    GLFWInputAdapter glfw_input_adapter{input_state};
+    /// @param top_right the top right corner of what the absolute position shader shows
+    const draw_info::IVPColor &update_fps_text(FrameArena &arena, int average_fps, const glm::vec3 &top_right);
+    const draw_info::IVPColor &update_iteration_count_text(FrameArena &arena, long long iteration_count,
+                                                           const glm::vec3 &top_right);
+    const draw_info::IVPColor &update_pos_text(FrameArena &arena, const glm::vec3 &pos, const glm::vec3 &top_right);
 
-    std::vector<ShaderType> requested_shaders;
+  private:
+    /// @param line_index 0 is the top line, each one after is a line further down
+    static vertex_geometry::Rectangle get_line_rect(const glm::vec3 &top_right, int line_index);
+};
 
-    ShaderCache shader_cache;
-    Batcher batcher;
+}; // namespace tbx_engine
 
-    FixedFrequencyLoop main_loop;
+/**
+ * @brief the parts of the engine which every variant needs, nothing in here touches a window, a gl context or an
+ * audio device so it can be used on machines without a gpu or sound card
+ *
+ * it owns the configuration, the input state and the main loop, and it runs the same tick plumbing as the full engine
+ *
+ * constructing it starts no threads, opens no sockets and watches no files, the job system's workers, the async
+ * logger's writer and the config file watch are set up by the first job, record and tick, the replication sockets by
+ * start and connect
+ */
+class ToolboxEngineCore {
+  protected:
+    const std::string default_config_file_path = "assets/config/user_cfg.ini";
 
   public:
-    InputGraphicsSoundMenu input_graphics_sound_menu;
-    bool &igs_menu_active;
-    // NOTE: this starts frozen so you have to unfreeze it to look around
-    FPSCamera fps_camera;
+    /// how long each stage of startup took and which thread it ran on, it is logged once the engine is constructed
+    tbx_engine::StartupReport startup_report;
 
-    std::unordered_map<SoundType, std::string> sound_type_to_file;
-    SoundSystem sound_system;
+  private:
+    tbx_engine::StartupStageMarker configuration_stage{startup_report, "configuration"};
 
-    UIRenderSuiteImpl ui_render_suite;
+  public:
+    Configuration configuration;
+    /// register handlers through this instead of the configuration directly so they can be hot reloaded
+    tbx_engine::ConfigHandlerRegistry config_handlers{configuration};
+    /// re-applies the keys that changed whenever the config file is saved, checked from the main loop, it's only
+    /// created by the first tick that runs with hot_reload_config on, so with that off the file is never watched,
+    /// the values being compared against are the ones configuration read at construction so nothing saved in between
+    /// is missed
+    std::optional<tbx_engine::ConfigHotReloader> config_hot_reloader;
+    bool hot_reload_config = true;
 
-    // startfold support for pausing updates from callbacks
+  private:
+    tbx_engine::StartupStageMarker core_systems_stage{startup_report, "core systems"};
 
-    ToolboxEngine(const std::string &program_name, std::vector<ShaderType> requested_shaders,
-                  std::unordered_map<SoundType, std::string> sound_type_to_file)
+  public:
+    Logger logger{"toolbox_engine"};
+    /// for logging from code that runs every frame or off the main thread, the caller only queues a record and a
+    /// background thread writes it, see AsyncLogger
+    tbx_engine::AsyncLogger async_logger;
+    /// the per frame hud and menu functions log the start and end of their scope here at trace level, it is raised to
+    /// [logging] frame_log_level and limited to a few hundred records per second so it can stay on in a release build
+    tbx_engine::LogSectionId frame_log_section = async_logger.register_section("frame");
+    InputState input_state;
+    GLFWInputAdapter glfw_input_adapter{input_state};
+    FixedFrequencyLoop main_loop;
+    /// waits out the rest of each frame unless the graphics wait_strategy is busy_wait, see FramePacingStrategy
+    tbx_engine::FramePacer frame_pacer;
+    /// lowers the rate of the main loop while the window is minimized, unfocused or idle, or the machine can't keep up
+    tbx_engine::FrameRateGovernor frame_rate_governor;
+    /// tells the frame rate governor what the window is doing, the windowed engines set this
+    std::function<tbx_engine::WindowActivity()> get_window_activity;
+    tbx_engine::ActionBindings action_bindings;
+
+    /// put parallel work here, every job submitted during a tick is finished before the frame is presented
+    tbx_engine::JobSystem job_system;
+    /// the job system's stats over the same window as the IterationStats last passed to the loop stats function
+    tbx_engine::JobSystemStats job_system_stats;
+
+    /// histograms of how long every frame and each phase of it took, see FrameTelemetry::start_shared_memory_export
+    /// to watch them from another process
+    tbx_engine::FrameTelemetry frame_telemetry;
+
+    tbx_engine::InputRecorder input_recorder;
+    tbx_engine::InputReplay input_replay;
+    /// when a replay finishes the default termination condition of start returns true, either way the replay is
+    /// stopped and live input and pacing resume
+    bool stop_when_replay_finishes = true;
+    /// cursor events, live or replayed, are passed to this as well as the input state, the windowed engine points it
+    /// at the camera
+    std::function<void(double, double)> on_cursor_pos;
+
+    /// the glfw callbacks push here and the events are applied once or twice per tick, see drain_input_events
+    tbx_engine::InputEventQueue input_event_queue;
+    /// every live event applied so far this tick with the time it arrived, after cursor motion was coalesced
+    std::vector<tbx_engine::InputEvent> input_events_this_tick;
+
+    /// the number of ticks the main loop has run since the engine was created
+    std::uint64_t tick_index = 0;
+
+    /// scratch memory for the current tick, eg hud strings and temporary geometry, it is reset at the end of every
+    /// tick so nothing allocated from it may be kept longer, see FrameArena
+    tbx_engine::FrameArena frame_arena;
+    /// how many heap allocations the main loop's thread made during the last tick, in steady state this should be
+    /// zero, always zero unless tbx_engine::allocation_counting_enabled
+    std::uint64_t num_heap_allocations_last_tick = 0;
+
+    /// register the bounds of drawable objects here, after a cull only the visible ones should be queued for drawing,
+    /// the windowed engines cull against their camera with cull_against_fps_camera
+    tbx_engine::FrustumCuller frustum_culler;
+
+    /// once started, whatever is in replication_server.entities at the end of a tick is sent to every client
+    tbx_engine::ReplicationServer replication_server;
+    /// once connected, receives a server's entities at the start of every tick, see get_interpolated_entities
+    tbx_engine::ReplicationClient replication_client;
+
+    ToolboxEngineCore()
         : configuration(default_config_file_path),
-          requested_resolution(tbx_engine::extract_width_height_from_resolution(
-                                   configuration.get_value("graphics", "resolution").value_or("1280x720"))
-                                   .value_or(default_resolution)),
-          window(requested_resolution.first, requested_resolution.second, program_name,
-                 tbx_engine::get_user_on_off_value_or_default(configuration, "graphics", "fullscreen"), false, false),
-          glfw_lambda_callback_manager(window.glfw_window), requested_shaders(requested_shaders),
-          shader_cache(requested_shaders), batcher(shader_cache),
           main_loop(
-              tbx_engine::parse_int_or_default(configuration.get_value("graphics", "max_fps").value_or("60"), 60)),
-          input_graphics_sound_menu(window, input_state, batcher, sound_system, configuration),
-          igs_menu_active(input_graphics_sound_menu.enabled), fps_camera(window.width_px, window.height_px),
-          sound_type_to_file(sound_type_to_file), sound_system(100, sound_type_to_file), ui_render_suite(batcher) {
-        auto all_callbacks =
-            tbx_engine::create_default_glcm_for_input_and_camera(glfw_input_adapter, fps_camera, window, shader_cache);
-        glfw_lambda_callback_manager.set_all_callbacks(all_callbacks);
-        glfw_lambda_callback_manager.register_all_callbacks_with_glfw();
-
-        fps_camera.freeze_camera();
-        tbx_engine::register_input_graphics_sound_config_handlers(configuration, fps_camera, main_loop);
-        // NOTE: this is required to render the menu
-        shader_cache.register_shader_program(ShaderType::ABSOLUTE_POSITION_WITH_COLORED_VERTEX);
-        configuration.apply_config_logic();
-        fps_camera.set_cursor_position = [&](double xpos, double ypos) { window.set_cursor_pos(xpos, ypos); };
-    }
-
-    vertex_geometry::Rectangle get_fullscreen_rect() {
-        auto [carsx, carsy] = window.get_corrective_aspect_ratio_scale();
-        vertex_geometry::Rectangle full_screen_rect(glm_utils::zero_R3, 2 * carsx, 2 * carsy);
-        return full_screen_rect;
+              tbx_engine::parse_int_or_default(configuration.get_value("graphics", "max_fps").value_or("60"), 60)) {
+        frame_pacer.set_target_rate_hz(
+            tbx_engine::parse_int_or_default(configuration.get_value("graphics", "max_fps").value_or("60"), 60));
+        tbx_engine::configure_main_loop_pacing(main_loop, frame_pacer);
+        action_bindings.register_config_handlers(config_handlers, input_state);
+
+        auto apply_frame_log_level = [&](const std::string &value) {
+            async_logger.set_section_settings(
+                frame_log_section, {tbx_engine::parse_log_level(value).value_or(tbx_engine::LogLevel::info), 300});
+        };
+        apply_frame_log_level(configuration.get_value("logging", "frame_log_level").value_or("info"));
+        config_handlers.register_config_handler("logging", "frame_log_level", apply_frame_log_level);
+
+        frame_rate_governor.set_full_rate_hz(frame_pacer.get_target_rate_hz());
+        governed_rate_hz = frame_pacer.get_target_rate_hz();
+        // NOTE: the main loop's own max_fps handler sets the pacer to the full rate, the governor puts its cap back on
+        // top of that on the next tick
+        config_handlers.register_config_handler("graphics", "max_fps", [&](const std::string value) {
+            if (value == "inf") {
+                frame_rate_governor.set_full_rate_hz(std::nullopt);
+            } else {
+                frame_rate_governor.set_full_rate_hz(
+                    tbx_engine::parse_int_or_default(value, frame_rate_governor.get_full_rate_hz().value_or(60)));
+            }
+        });
     }
 
-    enum class ActiveMouseMode {
-        CameraControl,  // Mouse moves the camera
-        MenuInteraction // Mouse interacts with UI menus
-    };
+    // NOTE: a recording that is still running when the engine goes away is closed here so its buffered events reach
+    // the file
+    ~ToolboxEngineCore() { input_recorder.stop_recording(); }
 
-    ActiveMouseMode active_mouse_mode = ToolboxEngine::ActiveMouseMode::MenuInteraction;
+    /// makes the default termination condition of start return true at the end of the current tick
+    void request_stop() { stop_requested = true; }
+    bool is_stop_requested() const { return stop_requested; }
 
-    // NOTE: must be called every frame so that it updates instantly
-    void update_active_mouse_mode(bool any_mouse_interactable_window_open) {
-        bool all_mouse_interactable_menus_closed = not any_mouse_interactable_window_open;
-        if (all_mouse_interactable_menus_closed) {
-            if (active_mouse_mode == ActiveMouseMode::MenuInteraction) {
-                fps_camera.unfreeze_camera();
-                window.disable_cursor();
-                active_mouse_mode = ActiveMouseMode::CameraControl;
-            }
-        } else {
-            if (active_mouse_mode == ActiveMouseMode::CameraControl) {
-                fps_camera.freeze_camera();
-                window.enable_cursor();
-                active_mouse_mode = ActiveMouseMode::MenuInteraction;
-            }
-        }
-    };
+    /**
+     * @brief records every input event from now on into file_path so the session can be replayed later
+     * @param fixed_dt the dt each tick will be given when the recording is replayed
+     */
+    bool start_input_recording(const std::string &file_path, double fixed_dt = 1.0 / 60) {
+        recording_start_tick_index = tick_index;
+        return input_recorder.start_recording(file_path, fixed_dt);
+    }
 
     /**
-     * @brief must be called to render the menu
+     * @brief feeds the events of a recording back into the input state tick by tick instead of live input
      *
+     * while the replay is active every tick gets the recording's fixed dt and the main loop runs as fast as possible,
+     * so a replay is deterministic and usually much faster than real time
      */
-    void process_and_queue_render_input_graphics_sound_menu() {
-        GlobalLogSection _("process_and_queue_render_input_graphics_sound_menu");
-
-        if (igs_menu_active) {
-            global_logger->info("igs menu active about to draw it");
-            input_graphics_sound_menu.process_and_queue_render_menu(window, input_state, ui_render_suite);
-        }
-
-        // NOTE: escape only opens the menu if no other menu is open ie camera control is on
-        if (input_state.is_just_pressed(EKey::ESCAPE) and active_mouse_mode == ActiveMouseMode::CameraControl) {
-            igs_menu_active = true;
-        }
-        if (input_state.is_just_pressed(EKey::ESCAPE) and active_mouse_mode == ActiveMouseMode::MenuInteraction) {
-            igs_menu_active = false;
+    bool start_input_replay(const std::string &file_path) {
+        if (!input_replay.start_replay(file_path)) {
+            return false;
         }
+        replay_start_tick_index = tick_index;
+        main_loop.set_operation_mode(FixedFrequencyLoop::OperationMode::as_fast_as_possible);
+        return true;
     }
 
-    // NOTE: this had to be named this to avoid a collidion with process_and_queue_rener_ui because UI doesn't use a
-    // namespace, and it should so fix that later
-    void process_and_queue_render_specific_ui(UI &ui) {
-
-        glm::vec2 acnmp = glm_utils::tuple_to_vec2(
-            window.convert_point_from_2d_screen_space_to_2d_aspect_corrected_normalized_screen_space(
-                input_state.mouse_position_x, input_state.mouse_position_y));
+    /// stops the replay and goes back to the configured update rate
+    void stop_input_replay() {
+        input_replay.stop_replay();
+        // NOTE: the replay only overrode the main loop's mode, the pacer kept its rate so the loop is set up from it
+        // again, its deadline is from before the replay so it's reset or the next frames would rush to catch up
+        tbx_engine::configure_main_loop_pacing(main_loop, frame_pacer);
+        frame_pacer.reset_deadline();
+    }
 
-        process_and_queue_render_ui(acnmp, ui, ui_render_suite, input_state.get_keys_just_pressed_this_tick(),
-                                    input_state.is_just_pressed(EKey::BACKSPACE),
-                                    input_state.is_just_pressed(EKey::ENTER),
-                                    input_state.is_just_pressed(EKey::LEFT_MOUSE_BUTTON));
+    movement::GodModeInput get_god_mode_movement_input() {
+        return action_bindings.get_god_mode_movement_input(input_state);
     }
 
-    /**
-     *  @brief draws the stats about the engine that the user has requested to see
-     */
-    void draw_chosen_engine_stats() {
-        if (configuration.is_on("graphics", "show_fps")) {
-            draw_fps();
-        }
-        if (configuration.is_on("graphics", "show_pos")) {
-            draw_pos();
-        }
-        if (configuration.is_on("graphics", "show_main_loop_iteration_count")) {
-            draw_iteration_count();
-        }
+    movement::FPSModeInput get_fps_mode_movement_input() {
+        return action_bindings.get_fps_mode_movement_input(input_state);
     }
 
-    draw_info::IVPColor fps_ivpc;
-    draw_info::IVPColor iteration_count_ivpc;
-    draw_info::IVPColor pos_ivpc;
+  protected:
+    bool stop_requested = false;
+    std::uint64_t recording_start_tick_index = 0;
+    std::uint64_t replay_start_tick_index = 0;
+    /// set on the tick a replay ran out of events, the replay itself is already stopped by then
+    bool replay_finished_this_tick = false;
+
+    void replay_input_events(tbx_engine::TickPhase phase) {
+        input_replay.replay_events(
+            tick_index - replay_start_tick_index, phase, [&](const tbx_engine::RecordedInputEvent &event) {
+                switch (event.type) {
+                case tbx_engine::RecordedInputEventType::key:
+                    glfw_input_adapter.glfw_key_callback(event.key, event.scancode, event.action, event.mods);
+                    break;
+                case tbx_engine::RecordedInputEventType::mouse_button:
+                    glfw_input_adapter.glfw_mouse_button_callback(event.key, event.action, event.mods);
+                    break;
+                case tbx_engine::RecordedInputEventType::cursor_pos:
+                    if (on_cursor_pos) {
+                        on_cursor_pos(event.x, event.y);
+                    }
+                    glfw_input_adapter.glfw_cursor_pos_callback(event.x, event.y);
+                    break;
+                }
+            });
+    }
 
     /**
-     * computes the visible volume of an absolute position shader, these all account for aspect ratio, and thus it
-     * is used here
+     * @brief applies every queued live input event to the input state in the order they arrived, and records them if
+     * a recording is running
      *
-     * also we can use an aabb because the abs position shader doesn't use any perspective so its not a frustum or
-     * something like that
+     * runs of cursor events are coalesced into their last position, so however fast the mouse polls the camera and
+     * input state see at most one cursor update between two key or button edges
      */
-    vertex_geometry::AxisAlignedBoundingBox get_visible_aabb_of_absolute_position_shader() {
-        auto [x_scale, y_scale] = window.get_corrective_aspect_ratio_scale();
-        glm::vec3 scale_vec{x_scale, y_scale, 1};
-        glm::vec3 min_corner = glm_utils::minus_one_R3 * scale_vec;
-        glm::vec3 max_corner = glm_utils::one_R3 * scale_vec;
-        return vertex_geometry::AxisAlignedBoundingBox(min_corner, max_corner);
+    void drain_input_events() {
+        TBX_PROFILE_SCOPE("drain_input_events");
+        tbx_engine::FramePhaseTimer phase_timer(frame_telemetry, tbx_engine::FramePhase::input);
+        input_event_queue.drain_coalesced([&](const tbx_engine::InputEvent &event) {
+            input_events_this_tick.push_back(event);
+            switch (event.type) {
+            case tbx_engine::RecordedInputEventType::key:
+                if (input_recorder.is_recording()) {
+                    input_recorder.record_key(event.key, event.scancode, event.action, event.mods,
+                                              event.get_arrival_time());
+                }
+                glfw_input_adapter.glfw_key_callback(event.key, event.scancode, event.action, event.mods);
+                break;
+            case tbx_engine::RecordedInputEventType::mouse_button:
+                if (input_recorder.is_recording()) {
+                    input_recorder.record_mouse_button(event.key, event.action, event.mods, event.get_arrival_time());
+                }
+                glfw_input_adapter.glfw_mouse_button_callback(event.key, event.action, event.mods);
+                break;
+            case tbx_engine::RecordedInputEventType::cursor_pos:
+                if (input_recorder.is_recording()) {
+                    input_recorder.record_cursor_pos(event.x, event.y, event.get_arrival_time());
+                }
+                if (on_cursor_pos) {
+                    on_cursor_pos(event.x, event.y);
+                }
+                glfw_input_adapter.glfw_cursor_pos_callback(event.x, event.y);
+                break;
+            }
+        });
     }
 
-    void draw_fps() {
-        GlobalLogSection _("draw_fps");
-        int average_fps = main_loop.average_fps.get();
-        auto top_right = get_visible_aabb_of_absolute_position_shader().get_max_xy_position();
-        auto side_length = 0.2;
-
-        // NOTE: here the copy assignment function is used, thus ids are not clobbered, but object becomes dirty,
-        // which is what we want.
-        fps_ivpc.copy_draw_data_from(draw_info::IVPColor(
-            grid_font::get_text_geometry(std::to_string(average_fps), vertex_geometry::create_rectangle_from_top_right(
-                                                                          top_right, side_length, side_length)),
-            colors::grey));
-
-        batcher.absolute_position_with_colored_vertex_shader_batcher.queue_draw(fps_ivpc);
+    void update_frame_rate_governor() {
+        tbx_engine::WindowActivity window_activity =
+            get_window_activity ? get_window_activity() : tbx_engine::WindowActivity();
+        std::uint64_t frame_ns = frame_telemetry.get_last_frame_ns(tbx_engine::FramePhase::frame);
+        std::uint64_t wait_ns = frame_telemetry.get_last_frame_ns(tbx_engine::FramePhase::wait);
+        // NOTE: with vsync on the buffer swap blocks until the display is ready, that is waiting rather than work, so
+        // counting it would make every vsynced frame look like it filled its budget and trip the load cap
+        std::uint64_t present_ns = frame_telemetry.get_last_frame_ns(tbx_engine::FramePhase::present);
+        std::uint64_t frame_work_ns = frame_ns > wait_ns + present_ns ? frame_ns - wait_ns - present_ns : 0;
+        // NOTE: if the pacer isn't at the rate the governor left it at, someone set it on purpose, eg the max_fps
+        // handler or a benchmark that runs unpaced, so that rate is the new full rate rather than something to undo
+        if (frame_pacer.get_target_rate_hz() != governed_rate_hz) {
+            frame_rate_governor.set_full_rate_hz(frame_pacer.get_target_rate_hz());
+        }
+        std::optional<double> rate_hz =
+            frame_rate_governor.update(std::chrono::steady_clock::now(), window_activity,
+                                       not input_events_this_tick.empty(), frame_work_ns / 1e9);
+        if (rate_hz != frame_pacer.get_target_rate_hz()) {
+            frame_pacer.set_target_rate_hz(rate_hz);
+            tbx_engine::configure_main_loop_pacing(main_loop, frame_pacer);
+        }
+        governed_rate_hz = rate_hz;
     }
 
-    void draw_iteration_count() {
-        GlobalLogSection _("draw_iteration_count");
-        auto loop_stats = main_loop.get_average_loop_stats();
-        auto top_right = get_visible_aabb_of_absolute_position_shader().get_max_xy_position();
-        auto side_length = 0.2;
-
-        // NOTE: here the copy assignment function is used, thus ids are not clobbered, but object becomes dirty,
-        // which is what we want.
-        iteration_count_ivpc.copy_draw_data_from(draw_info::IVPColor(
-            grid_font::get_text_geometry(
-                std::to_string(main_loop.iteration_count),
-                vertex_geometry::slide_rectangle(
-                    vertex_geometry::create_rectangle_from_top_right(top_right, side_length, side_length), 0, -1)),
-            colors::grey));
-
-        batcher.absolute_position_with_colored_vertex_shader_batcher.queue_draw(iteration_count_ivpc);
+    /// the rate update_frame_rate_governor last set the pacer to
+    std::optional<double> governed_rate_hz;
+
+    /// makes the pacer wait for glfw events instead of sleeping while the frame rate governor is throttling, so input
+    /// gets the full rate back right away instead of after a long throttled frame
+    /// @pre glfw has been initialized
+    void wait_for_window_events_while_throttled() {
+        frame_pacer.wait_for_events = [&](std::chrono::nanoseconds timeout) {
+            if (not frame_rate_governor.is_throttled()) {
+                std::this_thread::sleep_for(timeout);
+                return false;
+            }
+            glfwWaitEventsTimeout(std::chrono::duration<double>(timeout).count());
+            bool window_activity_changed =
+                get_window_activity and get_window_activity() != frame_rate_governor.get_last_window_activity();
+            return not input_event_queue.is_empty() or window_activity_changed;
+        };
     }
 
-    void draw_pos() {
-        GlobalLogSection _("draw_pos");
-
-        auto pos = fps_camera.transform.get_translation();
-        auto pos_str = vec3_to_string(pos, 2);
-
-        auto top_right = get_visible_aabb_of_absolute_position_shader().get_max_xy_position();
-        auto side_length = 0.2;
-
-        pos_ivpc.copy_draw_data_from(draw_info::IVPColor(
-            grid_font::get_text_geometry(
-                pos_str,
-                vertex_geometry::slide_rectangle(
-                    vertex_geometry::create_rectangle_from_top_right(top_right, side_length, side_length), 0, -2)),
-            colors::grey));
-
-        batcher.absolute_position_with_colored_vertex_shader_batcher.queue_draw(pos_ivpc);
+    /// wraps a termination condition so that a finished replay also ends the loop
+    std::function<bool()> with_replay_termination(const std::function<bool()> &termination_func) {
+        return [&, termination_func]() {
+            return termination_func() or (stop_when_replay_finishes and replay_finished_this_tick);
+        };
     }
 
-    movement::GodModeInput get_god_mode_movement_input() {
-        return {input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_slow_move)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_fast_move)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_forward)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_left)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_back)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_right)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_up)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_down))};
-    }
+    /**
+     * @brief runs the main loop with tick_func as the body of each iteration, input is processed at the end of every
+     * tick
+     * @param wait_for_jobs_at_end_of_tick when true every job submitted to the job system has finished by the end of
+     * the tick
+     */
+    void run_main_loop(const std::function<void(double)> &tick_func, const std::function<bool()> &termination_func,
+                       const std::optional<std::function<void(IterationStats)>> &loop_stats_function,
+                       bool wait_for_jobs_at_end_of_tick = true) {
+        main_loop.wait_strategy = FixedFrequencyLoop::WaitStrategy::busy_wait;
 
-    movement::FPSModeInput get_fps_mode_movement_input() {
-        return {input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_forward)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_back)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_right)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_left)),
-                input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                    input_state, configuration, tbx_engine::config_value_jump))};
+        std::optional<std::function<void(IterationStats)>> loop_stats_with_job_stats;
+        if (loop_stats_function.has_value()) {
+            loop_stats_with_job_stats = [&](IterationStats iteration_stats) {
+                job_system_stats = job_system.get_stats();
+                job_system.reset_stats();
+                (*loop_stats_function)(iteration_stats);
+            };
+        }
+
+        main_loop.start(
+            [&](double dt) {
+                tbx_engine::FrameProfiler &frame_profiler = tbx_engine::get_frame_profiler();
+                if (frame_profiler.is_enabled()) {
+                    frame_profiler.collect();
+                }
+                frame_profiler.begin_frame();
+
+                frame_telemetry.begin_frame(tick_index);
+                std::uint64_t num_heap_allocations_at_tick_start =
+                    tbx_engine::get_num_heap_allocations_on_this_thread();
+                TBX_PROFILE_SCOPE("tick");
+                input_events_this_tick.clear();
+                replay_finished_this_tick = false;
+
+                if (hot_reload_config) {
+                    TBX_PROFILE_SCOPE("config_hot_reloader.poll");
+                    if (not config_hot_reloader.has_value()) {
+                        config_hot_reloader.emplace(configuration, config_handlers, default_config_file_path);
+                    }
+                    config_hot_reloader->poll();
+                }
+
+                if (input_replay.is_active()) {
+                    dt = input_replay.get_fixed_dt();
+                }
+
+                if (replication_client.is_running()) {
+                    TBX_PROFILE_SCOPE("replication_client.update");
+                    replication_client.update(dt);
+                }
+
+                input_recorder.set_position(tick_index - recording_start_tick_index,
+                                            tbx_engine::TickPhase::before_update);
+                replay_input_events(tbx_engine::TickPhase::before_update);
+
+                tick_func(dt);
+
+                if (wait_for_jobs_at_end_of_tick) {
+                    TBX_PROFILE_SCOPE("job_system.wait_for_all");
+                    tbx_engine::FramePhaseTimer phase_timer(frame_telemetry, tbx_engine::FramePhase::jobs);
+                    job_system.wait_for_all();
+                }
+
+                if (replication_server.is_running()) {
+                    TBX_PROFILE_SCOPE("replication_server.update");
+                    replication_server.update(dt);
+                }
+
+                input_recorder.set_position(tick_index - recording_start_tick_index,
+                                            tbx_engine::TickPhase::after_update);
+                // NOTE: this picks up whatever glfw delivered during the end of the tick, eg while swapping buffers
+                drain_input_events();
+                replay_input_events(tbx_engine::TickPhase::after_update);
+                // NOTE: a finished replay is stopped even if the loop keeps going, otherwise live input would stay
+                // ignored and the loop would keep running unpaced with the replay's dt
+                if (input_replay.is_active() and input_replay.is_finished()) {
+                    stop_input_replay();
+                    replay_finished_this_tick = true;
+                }
+
+                {
+                    TBX_PROFILE_SCOPE("input_state.process");
+                    tbx_engine::FramePhaseTimer phase_timer(frame_telemetry, tbx_engine::FramePhase::input);
+                    input_state.process();
+                }
+                tick_index++;
+
+                // NOTE: replays run as fast as possible so they are never paced
+                if (not input_replay.is_active()) {
+                    update_frame_rate_governor();
+                }
+                if (frame_pacer.is_pacing() and not input_replay.is_active()) {
+                    TBX_PROFILE_SCOPE("frame_pacer.wait_for_next_frame");
+                    frame_pacer.wait_for_next_frame();
+                }
+
+                frame_arena.reset();
+                num_heap_allocations_last_tick =
+                    tbx_engine::get_num_heap_allocations_on_this_thread() - num_heap_allocations_at_tick_start;
+            },
+            with_replay_termination(termination_func), loop_stats_with_job_stats);
     }
+};
 
-    void update_camera_position_with_default_movement(double dt) {
-
-        fps_camera.update_position_based_on_keys_pressed(
-            input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                input_state, configuration, tbx_engine::config_value_slow_move)),
-            input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                input_state, configuration, tbx_engine::config_value_fast_move)),
-            input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                input_state, configuration, tbx_engine::config_value_forward)),
-            input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                input_state, configuration, tbx_engine::config_value_left)),
-            input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                input_state, configuration, tbx_engine::config_value_back)),
-            input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                input_state, configuration, tbx_engine::config_value_right)),
-            input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(input_state, configuration,
-                                                                                          tbx_engine::config_value_up)),
-            input_state.is_pressed(tbx_engine::get_input_key_from_config_or_default_value(
-                input_state, configuration, tbx_engine::config_value_down)),
-            dt);
+/**
+ * @brief an engine with no window, gl context or audio device, eg for a dedicated server or a ci box without a gpu
+ *
+ * the tick, input processing and configuration behave exactly like they do in ToolboxEngine, graphics and sound simply
+ * don't exist, so startup only costs parsing the config file
+ *
+ */
+class HeadlessToolboxEngine : public ToolboxEngineCore {
+  public:
+    HeadlessToolboxEngine() {
+        tbx_engine::register_main_loop_config_handlers(config_handlers, main_loop, frame_pacer);
+        startup_report.begin_main_thread_stage("apply_config_logic");
+        configuration.apply_config_logic();
+        startup_report.finish();
+        logger.info(startup_report.to_string());
     }
 
-    /**
-     * @brief Enables standard alpha blending in OpenGL.
-     *
-     * This function enables OpenGL's blending mode and configures it to use
-     * standard alpha transparency. When enabled, fragment colors are combined
-     * with existing framebuffer colors based on their alpha values, allowing
-     * for proper rendering of transparent textures and materials.
-     *
-     * The blending equation used is:
-     *     final_color = src_color * src_alpha + dst_color * (1 - src_alpha)
-     *
-     * This is the most common setup for rendering textures with transparency,
-     * such as UI elements, sprites, or decals.
-     *
-     * Example:
-     * @code
-     * enable_blending();
-     * draw_transparent_object();
-     * @endcode
-     */
-    void enable_blending() {
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    /// @note with no window to close the loop runs until request_stop is called, or until the termination condition
+    /// returns true if one is given
+    void start(const std::function<void(double)> &rate_limited_func,
+               const std::optional<std::function<bool()>> &termination_condition_func = std::nullopt,
+               std::optional<std::function<void(IterationStats)>> loop_stats_function = std::nullopt) {
+        std::function<bool()> term = termination_condition_func.value_or([&]() { return stop_requested; });
+        run_main_loop(
+            [&](double dt) {
+                TBX_PROFILE_SCOPE("rate_limited_func");
+                tbx_engine::FramePhaseTimer phase_timer(frame_telemetry, tbx_engine::FramePhase::update);
+                rate_limited_func(dt);
+            },
+            term, loop_stats_function);
     }
 };
 
+// NOTE: ToolboxEngine is the ComposedToolboxEngine with every system, so it is defined in there, this is included last
+// because the composed engines are built on ToolboxEngineCore
+#include "composed_toolbox_engine.hpp"
+
 #endif // TOOLBOX_ENGINE_HPP
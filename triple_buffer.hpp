@@ -0,0 +1,68 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace tbx_engine {
+
+/**
+ * @brief hands the latest value of T from one writer thread to one reader thread without locks or waiting
+ *
+ * there are three slots, the writer owns one, the reader owns another and the third is the one in the middle that
+ * was most recently published, publishing and picking up are a single atomic exchange of the middle slot, so neither
+ * side ever blocks the other, the reader always sees the newest complete value and values it was too slow to see are
+ * skipped
+ *
+ * @note the writer should fully overwrite the write buffer before publishing, it holds whatever was published two
+ * values ago
+ */
+template <typename T> class TripleBuffer {
+  public:
+    explicit TripleBuffer(const T &initial_value = T()) : slots{{{initial_value}, {initial_value}, {initial_value}}} {}
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    /// writer side, the slot to fill before calling publish
+    T &get_write_buffer() { return slots[write_index].value; }
+
+    /// writer side, makes the write buffer the newest value and hands the writer a free slot to use next
+    void publish() {
+        std::uint8_t previous_middle = middle.exchange(write_index | new_data_bit, std::memory_order_acq_rel);
+        write_index = previous_middle & index_mask;
+    }
+
+    /// reader side, picks up the newest published value if there is one
+    /// @return true if the read buffer changed
+    bool update_read_buffer() {
+        if ((middle.load(std::memory_order_relaxed) & new_data_bit) == 0) {
+            return false;
+        }
+        std::uint8_t previous_middle = middle.exchange(read_index, std::memory_order_acq_rel);
+        read_index = previous_middle & index_mask;
+        return true;
+    }
+
+    /// reader side, the newest value picked up by update_read_buffer
+    const T &get_read_buffer() const { return slots[read_index].value; }
+
+  private:
+    static constexpr std::uint8_t index_mask = 0b011;
+    static constexpr std::uint8_t new_data_bit = 0b100;
+
+    // NOTE: each slot gets its own cache line so the writer filling its slot doesn't slow down the reader
+    struct alignas(64) Slot {
+        T value;
+    };
+
+    std::array<Slot, 3> slots;
+    std::uint8_t write_index = 0;
+    alignas(64) std::atomic<std::uint8_t> middle{1};
+    alignas(64) std::uint8_t read_index = 2;
+};
+
+} // namespace tbx_engine
+
+#endif // TRIPLE_BUFFER_HPP
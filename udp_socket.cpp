@@ -0,0 +1,176 @@
+#include "udp_socket.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace tbx_engine {
+
+namespace {
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+const NativeSocket invalid_socket = INVALID_SOCKET;
+
+// NOTE: winsock has to be started once per process before any socket is made, the static takes care of that
+bool ensure_winsock_started() {
+    static bool started = [] {
+        WSADATA wsa_data;
+        return WSAStartup(MAKEWORD(2, 2), &wsa_data) == 0;
+    }();
+    return started;
+}
+#else
+using NativeSocket = int;
+const NativeSocket invalid_socket = -1;
+#endif
+
+sockaddr_in to_sockaddr(const NetworkEndpoint &endpoint) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(endpoint.address);
+    address.sin_port = htons(endpoint.port);
+    return address;
+}
+} // namespace
+
+std::optional<NetworkEndpoint> NetworkEndpoint::from_string(const std::string &address, std::uint16_t port) {
+    in_addr parsed;
+    if (inet_pton(AF_INET, address.c_str(), &parsed) != 1) {
+        return std::nullopt;
+    }
+    return NetworkEndpoint{ntohl(parsed.s_addr), port};
+}
+
+std::string NetworkEndpoint::to_string() const {
+    return std::to_string((address >> 24) & 0xff) + "." + std::to_string((address >> 16) & 0xff) + "." +
+           std::to_string((address >> 8) & 0xff) + "." + std::to_string(address & 0xff) + ":" + std::to_string(port);
+}
+
+bool UdpSocket::open(std::uint16_t port) {
+    close();
+#ifdef _WIN32
+    if (not ensure_winsock_started()) {
+        return false;
+    }
+#endif
+
+    NativeSocket native_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (native_socket == invalid_socket) {
+        return false;
+    }
+    handle = native_socket;
+
+    sockaddr_in address = to_sockaddr({INADDR_ANY, port});
+    if (bind(native_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        close();
+        return false;
+    }
+
+#ifdef _WIN32
+    u_long non_blocking = 1;
+    bool made_non_blocking = ioctlsocket(native_socket, FIONBIO, &non_blocking) == 0;
+    int address_length = sizeof(address);
+#else
+    bool made_non_blocking = fcntl(native_socket, F_SETFL, O_NONBLOCK) == 0;
+    socklen_t address_length = sizeof(address);
+#endif
+    if (not made_non_blocking or
+        getsockname(native_socket, reinterpret_cast<sockaddr *>(&address), &address_length) != 0) {
+        close();
+        return false;
+    }
+    local_port = ntohs(address.sin_port);
+    return true;
+}
+
+void UdpSocket::close() {
+    if (not is_open()) {
+        return;
+    }
+#ifdef _WIN32
+    closesocket(handle);
+#else
+    ::close(handle);
+#endif
+    handle = invalid_socket;
+    local_port = 0;
+    delayed_packets.clear();
+}
+
+bool UdpSocket::is_open() const { return handle != invalid_socket; }
+
+bool UdpSocket::send_now(const NetworkEndpoint &destination, const std::uint8_t *data, std::size_t size_bytes) {
+    sockaddr_in address = to_sockaddr(destination);
+    auto num_sent = sendto(handle, reinterpret_cast<const char *>(data), static_cast<int>(size_bytes), 0,
+                           reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    return num_sent == static_cast<decltype(num_sent)>(size_bytes);
+}
+
+void UdpSocket::send_due_packets() {
+    auto now = Clock::now();
+    // NOTE: with jitter the queue isn't sorted by send time, so every packet is checked, there are only ever a few
+    for (auto it = delayed_packets.begin(); it != delayed_packets.end();) {
+        if (it->send_time <= now) {
+            send_now(it->destination, it->data.data(), it->data.size());
+            it = delayed_packets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool UdpSocket::send_to(const NetworkEndpoint &destination, const std::uint8_t *data, std::size_t size_bytes) {
+    if (not is_open()) {
+        return false;
+    }
+    if (not simulated_conditions.is_active()) {
+        return send_now(destination, data, size_bytes);
+    }
+
+    send_due_packets();
+    std::uniform_real_distribution<double> unit(0, 1);
+    if (unit(rng) < simulated_conditions.loss_probability) {
+        // NOTE: a lost packet looks like a successful send to the caller, just like a real one would
+        return true;
+    }
+    double delay_s = simulated_conditions.latency_s + unit(rng) * simulated_conditions.jitter_s;
+    auto send_time = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(delay_s));
+    delayed_packets.push_back({send_time, destination, std::vector<std::uint8_t>(data, data + size_bytes)});
+    return true;
+}
+
+std::optional<std::size_t> UdpSocket::receive_from(NetworkEndpoint &source, std::uint8_t *buffer,
+                                                   std::size_t buffer_size) {
+    if (not is_open()) {
+        return std::nullopt;
+    }
+    send_due_packets();
+
+    sockaddr_in address{};
+#ifdef _WIN32
+    int address_length = sizeof(address);
+#else
+    socklen_t address_length = sizeof(address);
+#endif
+    auto num_received = recvfrom(handle, reinterpret_cast<char *>(buffer), static_cast<int>(buffer_size), 0,
+                                 reinterpret_cast<sockaddr *>(&address), &address_length);
+    // NOTE: on windows a packet to a closed port makes the next recvfrom fail with connection reset, that and would
+    // block are both treated as nothing to read
+    if (num_received < 0) {
+        return std::nullopt;
+    }
+    source = {ntohl(address.sin_addr.s_addr), ntohs(address.sin_port)};
+    return static_cast<std::size_t>(num_received);
+}
+
+} // namespace tbx_engine
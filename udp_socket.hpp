@@ -0,0 +1,89 @@
+#ifndef UDP_SOCKET_HPP
+#define UDP_SOCKET_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace tbx_engine {
+
+/// an ipv4 address and port, both in host byte order
+struct NetworkEndpoint {
+    std::uint32_t address = 0;
+    std::uint16_t port = 0;
+
+    bool operator==(const NetworkEndpoint &other) const = default;
+
+    /// @param address dotted decimal, eg "127.0.0.1"
+    static std::optional<NetworkEndpoint> from_string(const std::string &address, std::uint16_t port);
+    std::string to_string() const;
+};
+
+/// applied to every packet a UdpSocket sends, so loss and lag can be tried out over loopback
+struct SimulatedNetworkConditions {
+    /// between 0 and 1
+    double loss_probability = 0;
+    double latency_s = 0;
+    /// each packet gets an extra delay picked uniformly from [0, jitter_s], so packets can arrive out of order
+    double jitter_s = 0;
+
+    bool is_active() const { return loss_probability > 0 or latency_s > 0 or jitter_s > 0; }
+};
+
+/**
+ * @brief a non blocking ipv4 udp socket
+ *
+ * when simulated_conditions is active outgoing packets are dropped or held back here and only really sent once their
+ * delay is over, which happens during send_to and receive_from so no extra call is needed
+ *
+ */
+class UdpSocket {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    UdpSocket() = default;
+    ~UdpSocket() { close(); }
+    UdpSocket(const UdpSocket &) = delete;
+    UdpSocket &operator=(const UdpSocket &) = delete;
+
+    /// @param port 0 picks any free port, see get_local_port
+    bool open(std::uint16_t port = 0);
+    void close();
+    bool is_open() const;
+
+    std::uint16_t get_local_port() const { return local_port; }
+
+    bool send_to(const NetworkEndpoint &destination, const std::uint8_t *data, std::size_t size_bytes);
+    /// @return the number of bytes received, or std::nullopt when no packet is waiting
+    std::optional<std::size_t> receive_from(NetworkEndpoint &source, std::uint8_t *buffer, std::size_t buffer_size);
+
+    SimulatedNetworkConditions simulated_conditions;
+
+  private:
+    struct DelayedPacket {
+        Clock::time_point send_time;
+        NetworkEndpoint destination;
+        std::vector<std::uint8_t> data;
+    };
+
+    bool send_now(const NetworkEndpoint &destination, const std::uint8_t *data, std::size_t size_bytes);
+    void send_due_packets();
+
+#ifdef _WIN32
+    std::uintptr_t handle = ~std::uintptr_t(0);
+#else
+    int handle = -1;
+#endif
+    std::uint16_t local_port = 0;
+
+    std::deque<DelayedPacket> delayed_packets;
+    std::mt19937 rng{std::random_device{}()};
+};
+
+} // namespace tbx_engine
+
+#endif // UDP_SOCKET_HPP